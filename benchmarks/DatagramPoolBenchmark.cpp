@@ -0,0 +1,188 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Compare the memory behavior of RecycledDatagram recycled by recycler::Circular,
+// with InlineDatagram recycled by DatagramPool.
+//
+// Each iteration simulate a burst of received datagrams: every datagram is made by the pool,
+// filled like the Worker do, then read like Socket::onDatagramReceived do, and released in a random order.
+//
+// On Linux, hardware cache misses are counted with perf_event_open (might require 'kernel.perf_event_paranoid <= 2').
+//
+// Usage: NetUdp_DatagramPoolBenchmark [datagramCount] [iterations] [length]
+
+#include <NetUdp/RecycledDatagram.hpp>
+#include <NetUdp/DatagramPool.hpp>
+#include <Recycler/Circular.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#ifdef __linux__
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+class CacheMissCounter
+{
+public:
+    CacheMissCounter()
+    {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter()
+    {
+#ifdef __linux__
+        if(_fd >= 0)
+            close(_fd);
+#endif
+    }
+
+    bool isAvailable() const
+    {
+        return _fd >= 0;
+    }
+
+    void start()
+    {
+#ifdef __linux__
+        if(_fd < 0)
+            return;
+        ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    long long stop()
+    {
+        long long count = 0;
+#ifdef __linux__
+        if(_fd < 0)
+            return 0;
+        ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(_fd, &count, sizeof(count)) != sizeof(count))
+            count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int _fd = -1;
+};
+
+template<typename MakeDatagram>
+void runBenchmark(const char* name, MakeDatagram makeDatagram, std::size_t count, std::size_t iterations, std::size_t length)
+{
+    std::vector<netudp::SharedDatagram> inFlight;
+    inFlight.reserve(count);
+    std::mt19937 random(42);
+
+    // Fill the pool once, so the measure only include recycled datagrams
+    for(std::size_t i = 0; i < count; ++i)
+        inFlight.push_back(makeDatagram(length));
+    inFlight.clear();
+
+    CacheMissCounter counter;
+    std::uint64_t checksum = 0;
+
+    counter.start();
+    const auto begin = std::chrono::steady_clock::now();
+
+    for(std::size_t iteration = 0; iteration < iterations; ++iteration)
+    {
+        // Worker side: make and fill datagrams
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            auto datagram = makeDatagram(length);
+            datagram->buffer()[0] = std::uint8_t(i);
+            datagram->destinationPort = quint16(i);
+            datagram->senderPort = quint16(iteration);
+            datagram->ttl = 8;
+            inFlight.push_back(std::move(datagram));
+        }
+
+        // Socket side: read attributes and payload
+        for(const auto& datagram: inFlight)
+            checksum += datagram->destinationPort + datagram->senderPort + datagram->ttl + datagram->length() + datagram->buffer()[0];
+
+        // Consumers release datagrams in any order
+        std::shuffle(inFlight.begin(), inFlight.end(), random);
+        inFlight.clear();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    const auto cacheMisses = counter.stop();
+
+    const auto datagrams = double(count * iterations);
+    const auto ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+
+    if(counter.isAvailable())
+    {
+        std::printf("%-34s %8.1f ns/datagram %8.2f cache-misses/datagram (checksum %llu)\n",
+            name,
+            ns / datagrams,
+            double(cacheMisses) / datagrams,
+            static_cast<unsigned long long>(checksum));
+    }
+    else
+    {
+        std::printf("%-34s %8.1f ns/datagram (cache-misses unavailable) (checksum %llu)\n",
+            name,
+            ns / datagrams,
+            static_cast<unsigned long long>(checksum));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4096;
+    const std::size_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200;
+    const std::size_t length = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1400;
+
+    std::printf("%zu datagrams of %zu bytes, %zu iterations\n", count, length, iterations);
+
+    {
+        recycler::Circular<netudp::RecycledDatagram> cache;
+        cache.resize(count);
+        runBenchmark(
+            "RecycledDatagram/recycler::Circular",
+            [&](std::size_t length) -> netudp::SharedDatagram { return cache.make(length); },
+            count,
+            iterations,
+            length);
+    }
+
+    {
+        netudp::DatagramPool pool(count);
+        runBenchmark(
+            "InlineDatagram/DatagramPool",
+            [&](std::size_t length) -> netudp::SharedDatagram { return pool.make(length); },
+            count,
+            iterations,
+            length);
+    }
+
+    return 0;
+}
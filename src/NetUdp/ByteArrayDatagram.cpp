@@ -0,0 +1,60 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <NetUdp/ByteArrayDatagram.hpp>
+
+namespace netudp {
+
+ByteArrayDatagram::ByteArrayDatagram(QByteArray data)
+    : _data(std::move(data))
+{
+}
+
+void ByteArrayDatagram::reset()
+{
+    _data = QByteArray();
+    Datagram::reset();
+}
+
+void ByteArrayDatagram::reset(const std::size_t length)
+{
+    _data = QByteArray(int(length), Qt::Uninitialized);
+    Datagram::reset(length);
+}
+
+void ByteArrayDatagram::resize(std::size_t length)
+{
+    _data.resize(int(length));
+}
+
+std::uint8_t* ByteArrayDatagram::buffer()
+{
+    return reinterpret_cast<std::uint8_t*>(_data.data());
+}
+
+const std::uint8_t* ByteArrayDatagram::buffer() const
+{
+    return reinterpret_cast<const std::uint8_t*>(_data.constData());
+}
+
+std::size_t ByteArrayDatagram::length() const
+{
+    return std::size_t(_data.size());
+}
+
+const QByteArray& ByteArrayDatagram::data() const
+{
+    return _data;
+}
+
+void ByteArrayDatagram::setData(QByteArray data)
+{
+    _data = std::move(data);
+}
+
+}
@@ -0,0 +1,71 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_CONST_BUFFER_HPP__
+#define __NETUDP_CONST_BUFFER_HPP__
+
+#include <NetUdp/Export.hpp>
+#include <NetUdp/Datagram.hpp>
+#include <QtCore/QMetaType>
+#include <QtCore/QByteArray>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace netudp {
+
+// Read only view over a memory region, used to send a datagram made of several buffers without concatenating them.
+// 'owner' keep the memory pointed by 'data' alive until the worker wrote the datagram to the network.
+// If 'owner' is null, the caller is responsible to keep 'data' alive until the datagram is sent.
+struct ConstBuffer
+{
+    ConstBuffer() = default;
+    ConstBuffer(const std::uint8_t* data, std::size_t length, std::shared_ptr<const void> owner = nullptr)
+        : data(data)
+        , length(length)
+        , owner(std::move(owner))
+    {
+    }
+
+    ConstBuffer(const char* data, std::size_t length, std::shared_ptr<const void> owner = nullptr)
+        : ConstBuffer(reinterpret_cast<const std::uint8_t*>(data), length, std::move(owner))
+    {
+    }
+
+    // Reference the whole content of 'datagram', and keep it alive.
+    static ConstBuffer fromDatagram(std::shared_ptr<const Datagram> datagram)
+    {
+        if(!datagram)
+            return {};
+
+        const auto* data = datagram->buffer();
+        const auto length = datagram->length();
+        return ConstBuffer(data, length, std::move(datagram));
+    }
+
+    // Reference the content of 'data' without deep copy, the implicitly shared data is kept alive.
+    static ConstBuffer fromByteArray(const QByteArray& data)
+    {
+        auto owner = std::make_shared<const QByteArray>(data);
+        const auto* bytes = owner->constData();
+        const auto length = std::size_t(owner->size());
+        return ConstBuffer(bytes, length, std::move(owner));
+    }
+
+    const std::uint8_t* data = nullptr;
+    std::size_t length = 0;
+    std::shared_ptr<const void> owner;
+};
+
+using ConstBufferList = std::vector<ConstBuffer>;
+
+}
+
+Q_DECLARE_METATYPE(netudp::ConstBufferList);
+
+#endif
@@ -7,11 +7,18 @@
 // THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <NetUdp/Datagram.hpp>
+#include <NetUdp/RxMemoryBudget.hpp>
 
 namespace netudp {
 
+Datagram::~Datagram()
+{
+    releaseBudget();
+}
+
 void Datagram::reset()
 {
+    releaseBudget();
     destinationAddress = QString();
     destinationPort = 0;
     senderAddress = QString();
@@ -28,4 +35,34 @@ void Datagram::resize(std::size_t length)
 {
 }
 
+std::size_t Datagram::capacity() const
+{
+    return length();
+}
+
+bool Datagram::acquireBudget(RxMemoryBudget& budget, qreal weight)
+{
+    // Nothing to account when the budget is disabled
+    if(_budget || !budget.capacity())
+        return true;
+
+    const auto charge = capacity();
+    if(!budget.tryAcquire(charge, weight))
+        return false;
+
+    _budget = &budget;
+    _budgetCharge = charge;
+    return true;
+}
+
+void Datagram::releaseBudget()
+{
+    if(!_budget)
+        return;
+
+    _budget->release(_budgetCharge);
+    _budget = nullptr;
+    _budgetCharge = 0;
+}
+
 }
@@ -16,11 +16,15 @@
 
 namespace netudp {
 
+class RxMemoryBudget;
+
 class NETUDP_API_ Datagram
 {
     // ────── CONSTRUCTOR ────────
 public:
-    virtual ~Datagram() = default;
+    virtual ~Datagram();
+
+    // Reset also release the charge on RxMemoryBudget, so recycled datagrams are accounted only once
     virtual void reset();
 
     // Reset the datagram and clear the content.
@@ -36,6 +40,14 @@ public:
     virtual const std::uint8_t* buffer() const = 0;
     virtual std::size_t length() const = 0;
 
+    // Bytes of memory held for the payload. Default to 'length'.
+    virtual std::size_t capacity() const;
+
+    // Charge 'capacity' bytes to 'budget' until the datagram is reset or destroyed.
+    // Return false if the budget is exhausted for 'weight', see RxMemoryBudget::tryAcquire.
+    bool acquireBudget(RxMemoryBudget& budget, qreal weight);
+    void releaseBudget();
+
     // ────── ATTRIBUTES ────────
 public:
     QString destinationAddress;
@@ -45,6 +57,11 @@ public:
     quint16 senderPort = 0;
 
     quint8 ttl = 0;
+
+private:
+    // Set when the datagram is charged to a budget
+    RxMemoryBudget* _budget = nullptr;
+    std::size_t _budgetCharge = 0;
 };
 
 typedef std::shared_ptr<Datagram> SharedDatagram;
@@ -0,0 +1,610 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <NetUdp/DatagramPool.hpp>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QDebug>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifdef Q_OS_LINUX
+#    include <sys/mman.h>
+#endif
+
+Q_LOGGING_CATEGORY(netudp_pool_log, "netudp.pool");
+
+namespace netudp {
+
+// Datagram capacity is rounded to a cache line, so datagrams with similar length can be recycled for each others.
+static constexpr std::size_t datagramPoolRoundUp(std::size_t length)
+{
+    return (length + InlineDatagram::alignment - 1) & ~(InlineDatagram::alignment - 1);
+}
+
+// Room reserved in front of the payload of every block for the shared_ptr control block.
+// The payload offset is the same for every block, so blocks carved from an arena can be used by any datagram.
+static constexpr std::size_t datagramPoolHeaderLength = datagramPoolRoundUp(sizeof(InlineDatagram) + 64);
+
+// Explicit huge page arenas are rounded to this length
+static constexpr std::size_t datagramPoolHugePageLength = 2 * 1024 * 1024;
+
+// Contiguous memory carved in blocks by DatagramPool::prewarm. Freed when its last block is freed.
+struct DatagramPoolArena
+{
+    void* memory = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+    std::atomic<std::size_t> blocks = {0};
+};
+
+// Overlay a block once its datagram was destroyed, while it wait in a free list.
+struct DatagramPoolBlock
+{
+    DatagramPoolBlock* next = nullptr;
+    std::size_t capacity = 0;
+    DatagramPoolArena* arena = nullptr;
+};
+
+static DatagramPoolArena* datagramPoolMapArena(std::size_t length, DatagramPool::HugePages hugePages)
+{
+    auto* const arena = new DatagramPoolArena;
+
+#ifdef Q_OS_LINUX
+#    ifdef MAP_HUGETLB
+    if(hugePages == DatagramPool::ExplicitHugePages)
+    {
+        const auto hugeLength = (length + datagramPoolHugePageLength - 1) & ~(datagramPoolHugePageLength - 1);
+        void* const memory =
+            ::mmap(nullptr, hugeLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if(memory != MAP_FAILED)
+        {
+            arena->memory = memory;
+            arena->length = hugeLength;
+            arena->mapped = true;
+            return arena;
+        }
+        qCDebug(netudp_pool_log) << "Fail to map " << hugeLength << " bytes of explicit huge pages, fallback to regular pages";
+    }
+#    endif
+
+    void* const memory = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory != MAP_FAILED)
+    {
+#    ifdef MADV_HUGEPAGE
+        if(hugePages != DatagramPool::NoHugePages)
+            ::madvise(memory, length, MADV_HUGEPAGE);
+#    endif
+        arena->memory = memory;
+        arena->length = length;
+        arena->mapped = true;
+    }
+#else
+    Q_UNUSED(hugePages);
+#endif
+
+    if(!arena->mapped)
+    {
+        arena->memory = ::operator new(length, std::align_val_t(InlineDatagram::alignment));
+        arena->length = length;
+    }
+
+    // Fault every page now, rather than while receiving the first datagrams
+    std::memset(arena->memory, 0, arena->length);
+    return arena;
+}
+
+static void datagramPoolUnmapArena(DatagramPoolArena* arena)
+{
+#ifdef Q_OS_LINUX
+    if(arena->mapped)
+        ::munmap(arena->memory, arena->length);
+#endif
+    if(!arena->mapped)
+        ::operator delete(arena->memory, std::align_val_t(InlineDatagram::alignment));
+    delete arena;
+}
+
+static void datagramPoolFree(DatagramPoolBlock* block)
+{
+    auto* const arena = block->arena;
+    if(!arena)
+    {
+        ::operator delete(block, std::align_val_t(InlineDatagram::alignment));
+        return;
+    }
+
+    if(arena->blocks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        datagramPoolUnmapArena(arena);
+}
+
+// Shared between the pool and every block it allocated.
+// Destroyed by the pool if every block is back, otherwise by the last block released after the pool was destroyed.
+class DatagramPoolCore
+{
+public:
+    // Called by the allocator of a datagram when its control block is deallocated, from any thread.
+    void recycle(void* memory, std::size_t capacity, DatagramPoolArena* arena)
+    {
+        releases[DatagramPool::sizeClass(capacity)].fetch_add(1, std::memory_order_relaxed);
+        totalReleases.fetch_add(1, std::memory_order_relaxed);
+
+        auto* const block = new(memory) DatagramPoolBlock;
+        block->capacity = capacity;
+        block->arena = arena;
+
+        auto* head = returned.load(std::memory_order_relaxed);
+        do
+        {
+            // The pool is gone, nobody will reuse this block
+            if(head == closed())
+            {
+                datagramPoolFree(block);
+                if(blocks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    delete this;
+                return;
+            }
+            block->next = head;
+        } while(!returned.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    static DatagramPoolBlock* closed()
+    {
+        static DatagramPoolBlock sentinel;
+        return &sentinel;
+    }
+
+    // Treiber stack of blocks released by any thread. Only the owner pop, and always the whole stack.
+    std::atomic<DatagramPoolBlock*> returned = {nullptr};
+
+    // Number of blocks allocated and not yet freed
+    std::atomic<std::size_t> blocks = {0};
+
+    // Indexed by size class, the last one count datagrams bigger than every class
+    std::array<std::atomic<quint64>, DatagramPool::SizeClassCount + 1> releases = {};
+    std::atomic<quint64> totalReleases = {0};
+};
+
+// Allocate the shared_ptr control block (that embed the InlineDatagram) and the payload in a single block,
+// either a new one or 'recycled'. Deallocation give the block back to the pool core, or free it without 'core'.
+// The allocator stored in the control block is a copy of the one given to allocate_shared, not the one allocating,
+// so everything needed at deallocation ('arena') must be known before the allocation.
+template<typename T>
+struct DatagramPoolAllocator
+{
+    using value_type = T;
+
+    DatagramPoolAllocator(DatagramPoolCore* core, DatagramPoolBlock* recycled, std::size_t capacity, std::uint8_t** payload)
+        : core(core)
+        , recycled(recycled)
+        , arena(recycled ? recycled->arena : nullptr)
+        , capacity(capacity)
+        , payload(payload)
+    {
+    }
+
+    template<typename U>
+    DatagramPoolAllocator(const DatagramPoolAllocator<U>& other)
+        : core(other.core)
+        , recycled(other.recycled)
+        , arena(other.arena)
+        , capacity(other.capacity)
+        , payload(other.payload)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        static_assert(sizeof(T) <= datagramPoolHeaderLength, "shared_ptr control block doesn't fit in datagramPoolHeaderLength");
+        Q_ASSERT(n == 1);
+
+        const auto header = datagramPoolHeaderLength;
+        std::uint8_t* block = nullptr;
+        if(recycled)
+        {
+            block = reinterpret_cast<std::uint8_t*>(recycled);
+            recycled = nullptr;
+        }
+        else
+        {
+            block = static_cast<std::uint8_t*>(::operator new(header + capacity, std::align_val_t(InlineDatagram::alignment)));
+            if(core)
+                core->blocks.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if(payload)
+            *payload = block + header;
+
+        return reinterpret_cast<T*>(block);
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        if(core)
+            core->recycle(p, capacity, arena);
+        else
+            ::operator delete(p, std::align_val_t(InlineDatagram::alignment));
+    }
+
+    template<typename U>
+    bool operator==(const DatagramPoolAllocator<U>& other) const
+    {
+        return core == other.core;
+    }
+
+    template<typename U>
+    bool operator!=(const DatagramPoolAllocator<U>& other) const
+    {
+        return !(*this == other);
+    }
+
+    DatagramPoolCore* core;
+    DatagramPoolBlock* recycled;
+    DatagramPoolArena* arena;
+    std::size_t capacity;
+    std::uint8_t** payload;
+};
+
+std::shared_ptr<InlineDatagram> InlineDatagram::make(std::size_t capacity)
+{
+    // Written by the allocator before the datagram is constructed
+    std::uint8_t* payload = nullptr;
+    return std::allocate_shared<InlineDatagram>(
+        DatagramPoolAllocator<InlineDatagram>(nullptr, nullptr, capacity, &payload), PrivateTag(), &payload, capacity);
+}
+
+bool DatagramPoolStatistics::operator==(const DatagramPoolStatistics& other) const
+{
+    return hits == other.hits && misses == other.misses && releases == other.releases && free == other.free && inUse == other.inUse
+           && peakInUse == other.peakInUse && bytesReserved == other.bytesReserved && size == other.size && grows == other.grows
+           && shrinks == other.shrinks;
+}
+
+bool DatagramPoolStatistics::operator!=(const DatagramPoolStatistics& other) const
+{
+    return !(*this == other);
+}
+
+// Indexed by DatagramPool::SizeClass
+static constexpr std::size_t datagramPoolClassCapacities[DatagramPool::SizeClassCount] = {
+    256,
+    datagramPoolRoundUp(1500),
+    datagramPoolRoundUp(9000),
+    65536,
+};
+
+std::size_t DatagramPool::capacity(SizeClass sizeClass)
+{
+    Q_ASSERT(sizeClass < SizeClassCount);
+    return datagramPoolClassCapacities[sizeClass];
+}
+
+DatagramPool::SizeClass DatagramPool::sizeClass(std::size_t length)
+{
+    for(int i = 0; i < SizeClassCount; ++i)
+    {
+        const auto sizeClass = SizeClass(i);
+        if(length <= capacity(sizeClass))
+            return sizeClass;
+    }
+    return SizeClassCount;
+}
+
+DatagramPool::DatagramPool(std::size_t size)
+    : _core(new DatagramPoolCore)
+    , _size(size)
+{
+    for(auto& pool: _pools)
+        pool.size = size;
+}
+
+DatagramPool::~DatagramPool()
+{
+    // From now on, released blocks are freed by their last owner
+    auto* block = _core->returned.exchange(DatagramPoolCore::closed(), std::memory_order_acq_rel);
+
+    std::size_t freed = 0;
+    while(block)
+    {
+        auto* const next = block->next;
+        datagramPoolFree(block);
+        block = next;
+        ++freed;
+    }
+    for(auto& pool: _pools)
+    {
+        for(auto* const free: pool.free)
+        {
+            datagramPoolFree(free);
+            ++freed;
+        }
+    }
+
+    if(_core->blocks.fetch_sub(freed, std::memory_order_acq_rel) == freed)
+        delete _core;
+}
+
+std::size_t DatagramPool::size() const
+{
+    return _size;
+}
+
+bool DatagramPool::resize(std::size_t size)
+{
+    bool changed = size != _size;
+    _size = size;
+    for(int i = 0; i < SizeClassCount; ++i)
+        changed |= resize(SizeClass(i), size);
+    return changed;
+}
+
+std::size_t DatagramPool::size(SizeClass sizeClass) const
+{
+    Q_ASSERT(sizeClass < SizeClassCount);
+    return _pools[sizeClass].size;
+}
+
+bool DatagramPool::resize(SizeClass sizeClass, std::size_t size)
+{
+    Q_ASSERT(sizeClass < SizeClassCount);
+    auto& pool = _pools[sizeClass];
+    if(pool.size == size)
+        return false;
+
+    pool.size = size;
+    trim(pool);
+    return true;
+}
+
+std::size_t DatagramPool::freeCount(SizeClass sizeClass) const
+{
+    Q_ASSERT(sizeClass < SizeClassCount);
+    return _pools[sizeClass].free.size();
+}
+
+DatagramPool::HugePages DatagramPool::hugePages() const
+{
+    return _hugePages;
+}
+
+void DatagramPool::setHugePages(HugePages hugePages)
+{
+    _hugePages = hugePages;
+}
+
+const DatagramPoolAdaptivePolicy& DatagramPool::adaptivePolicy() const
+{
+    return _adaptivePolicy;
+}
+
+void DatagramPool::setAdaptivePolicy(const DatagramPoolAdaptivePolicy& policy)
+{
+    _adaptivePolicy = policy;
+}
+
+void DatagramPool::adapt(quint64 elapsed)
+{
+    if(!_adaptivePolicy.enabled)
+        return;
+
+    for(int i = 0; i < SizeClassCount; ++i)
+    {
+        auto& pool = _pools[i];
+        auto& counters = _counters[i];
+
+        // Start the next window with the datagrams still in use
+        const auto windowPeak = pool.windowPeakInUse;
+        pool.windowPeakInUse = counters.hits + counters.misses - _core->releases[i].load(std::memory_order_relaxed);
+
+        if(windowPeak > pool.size && pool.size < _adaptivePolicy.maximumSize)
+        {
+            pool.size = std::size_t(std::min<quint64>(windowPeak, _adaptivePolicy.maximumSize));
+            pool.quietPeakInUse = 0;
+            pool.quietTime = 0;
+            ++counters.grows;
+            continue;
+        }
+
+        pool.quietPeakInUse = std::max(pool.quietPeakInUse, windowPeak);
+        pool.quietTime += elapsed;
+        if(pool.quietTime < _adaptivePolicy.idleTimeout)
+            continue;
+
+        const auto decayedSize = std::size_t(std::max<quint64>(pool.quietPeakInUse, _adaptivePolicy.minimumSize));
+        if(decayedSize < pool.size)
+        {
+            pool.size = decayedSize;
+            trim(pool);
+            ++counters.shrinks;
+        }
+        pool.quietPeakInUse = 0;
+        pool.quietTime = 0;
+    }
+}
+
+std::size_t DatagramPool::prewarm(SizeClass sizeClass, std::size_t count)
+{
+    Q_ASSERT(sizeClass < SizeClassCount);
+    auto& pool = _pools[sizeClass];
+
+    const auto target = std::min(count, pool.size);
+    if(pool.free.size() >= target)
+        return 0;
+
+    const auto missing = target - pool.free.size();
+    const auto blockCapacity = capacity(sizeClass);
+    const auto blockLength = datagramPoolHeaderLength + blockCapacity;
+
+    auto* const arena = datagramPoolMapArena(missing * blockLength, _hugePages);
+    _counters[sizeClass].bytesReserved += missing * blockLength;
+    arena->blocks.store(missing, std::memory_order_relaxed);
+    _core->blocks.fetch_add(missing, std::memory_order_relaxed);
+
+    auto* const memory = static_cast<std::uint8_t*>(arena->memory);
+    for(std::size_t i = 0; i < missing; ++i)
+    {
+        auto* const block = new(memory + i * blockLength) DatagramPoolBlock;
+        block->capacity = blockCapacity;
+        block->arena = arena;
+        pool.free.push_back(block);
+    }
+
+    return missing;
+}
+
+std::size_t DatagramPool::prewarm(std::size_t count)
+{
+    std::size_t allocated = 0;
+    for(int i = 0; i < SizeClassCount; ++i)
+        allocated += prewarm(SizeClass(i), count);
+    return allocated;
+}
+
+void DatagramPool::clear()
+{
+    for(auto& pool: _pools)
+    {
+        for(auto* const block: pool.free)
+            destroy(block);
+        pool.free.clear();
+    }
+}
+
+void DatagramPool::release()
+{
+    drain();
+    clear();
+}
+
+std::shared_ptr<InlineDatagram> DatagramPool::make(std::size_t length)
+{
+    const auto datagramClass = sizeClass(length);
+
+    DatagramPoolBlock* block = nullptr;
+    std::size_t blockCapacity = datagramPoolRoundUp(length);
+    if(datagramClass != SizeClassCount)
+    {
+        auto& pool = _pools[datagramClass];
+        if(pool.free.empty())
+            drain();
+        if(!pool.free.empty())
+        {
+            block = pool.free.back();
+            pool.free.pop_back();
+        }
+        blockCapacity = capacity(datagramClass);
+    }
+
+    // Written by the allocator before the datagram is constructed
+    std::uint8_t* payload = nullptr;
+    auto datagram = std::allocate_shared<InlineDatagram>(DatagramPoolAllocator<InlineDatagram>(_core, block, blockCapacity, &payload),
+        InlineDatagram::PrivateTag(),
+        &payload,
+        blockCapacity);
+    datagram->reset(length);
+
+    auto& counters = _counters[datagramClass];
+    if(block)
+    {
+        ++counters.hits;
+    }
+    else
+    {
+        ++counters.misses;
+        counters.bytesReserved += datagramPoolHeaderLength + blockCapacity;
+    }
+    ++_made;
+
+    // Releases can only be late, never ahead of makes
+    const auto inUse = counters.hits + counters.misses - _core->releases[datagramClass].load(std::memory_order_relaxed);
+    counters.peakInUse = std::max(counters.peakInUse, inUse);
+    if(datagramClass != SizeClassCount)
+        _pools[datagramClass].windowPeakInUse = std::max(_pools[datagramClass].windowPeakInUse, inUse);
+    _peakInUse = std::max(_peakInUse, _made - _core->totalReleases.load(std::memory_order_relaxed));
+
+    return datagram;
+}
+
+DatagramPoolStatistics DatagramPool::statistics() const
+{
+    DatagramPoolStatistics total;
+    for(int i = 0; i <= SizeClassCount; ++i)
+    {
+        const auto statistics = this->statistics(SizeClass(i));
+        total.hits += statistics.hits;
+        total.misses += statistics.misses;
+        total.releases += statistics.releases;
+        total.free += statistics.free;
+        total.inUse += statistics.inUse;
+        total.bytesReserved += statistics.bytesReserved;
+        total.size += statistics.size;
+        total.grows += statistics.grows;
+        total.shrinks += statistics.shrinks;
+    }
+    total.peakInUse = _peakInUse;
+    return total;
+}
+
+DatagramPoolStatistics DatagramPool::statistics(SizeClass sizeClass) const
+{
+    Q_ASSERT(sizeClass <= SizeClassCount);
+    const auto& counters = _counters[sizeClass];
+
+    DatagramPoolStatistics statistics;
+    statistics.hits = counters.hits;
+    statistics.misses = counters.misses;
+    statistics.releases = _core->releases[sizeClass].load(std::memory_order_relaxed);
+    statistics.free = sizeClass < SizeClassCount ? _pools[sizeClass].free.size() : 0;
+    statistics.inUse = counters.hits + counters.misses - statistics.releases;
+    statistics.peakInUse = counters.peakInUse;
+    statistics.bytesReserved = counters.bytesReserved;
+    statistics.size = sizeClass < SizeClassCount ? _pools[sizeClass].size : 0;
+    statistics.grows = counters.grows;
+    statistics.shrinks = counters.shrinks;
+    return statistics;
+}
+
+void DatagramPool::drain()
+{
+    // Take the whole stack at once, there is no concurrent pop so no ABA problem
+    auto* block = _core->returned.exchange(nullptr, std::memory_order_acquire);
+    while(block)
+    {
+        auto* const next = block->next;
+
+        // Oversized blocks belong to no class
+        const auto blockClass = sizeClass(block->capacity);
+        if(blockClass != SizeClassCount && _pools[blockClass].free.size() < _pools[blockClass].size)
+            _pools[blockClass].free.push_back(block);
+        else
+            destroy(block);
+
+        block = next;
+    }
+}
+
+void DatagramPool::trim(Pool& pool)
+{
+    while(pool.free.size() > pool.size)
+    {
+        destroy(pool.free.back());
+        pool.free.pop_back();
+    }
+}
+
+void DatagramPool::destroy(DatagramPoolBlock* block)
+{
+    _counters[sizeClass(block->capacity)].bytesReserved -= datagramPoolHeaderLength + block->capacity;
+    datagramPoolFree(block);
+    _core->blocks.fetch_sub(1, std::memory_order_relaxed);
+}
+
+}
+
+#include "moc_DatagramPool.cpp"
@@ -0,0 +1,211 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_DATAGRAM_POOL_HPP__
+#define __NETUDP_DATAGRAM_POOL_HPP__
+
+#include <NetUdp/Export.hpp>
+#include <NetUdp/InlineDatagram.hpp>
+#include <QtCore/QObject>
+#include <QtCore/QMetaType>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace netudp {
+
+class DatagramPoolCore;
+struct DatagramPoolBlock;
+
+// Snapshot of the counters of a DatagramPool, or of one of its size classes
+struct NETUDP_API_ DatagramPoolStatistics
+{
+    Q_GADGET
+    Q_PROPERTY(quint64 hits MEMBER hits)
+    Q_PROPERTY(quint64 misses MEMBER misses)
+    Q_PROPERTY(quint64 releases MEMBER releases)
+    Q_PROPERTY(quint64 free MEMBER free)
+    Q_PROPERTY(quint64 inUse MEMBER inUse)
+    Q_PROPERTY(quint64 peakInUse MEMBER peakInUse)
+    Q_PROPERTY(quint64 bytesReserved MEMBER bytesReserved)
+    Q_PROPERTY(quint64 size MEMBER size)
+    Q_PROPERTY(quint64 grows MEMBER grows)
+    Q_PROPERTY(quint64 shrinks MEMBER shrinks)
+
+public:
+    // Datagrams made from a recycled block
+    quint64 hits = 0;
+    // Datagrams that required a new allocation
+    quint64 misses = 0;
+    // Datagrams released by their last owner
+    quint64 releases = 0;
+    // Datagrams ready to be reused by the owner, without the releases not yet drained
+    quint64 free = 0;
+    // Datagrams made and not yet released
+    quint64 inUse = 0;
+    // Maximum of 'inUse' observed when making a datagram
+    quint64 peakInUse = 0;
+    // Bytes allocated by the pool and not freed, wherever the blocks are (free or in use)
+    quint64 bytesReserved = 0;
+    // Maximum number of free datagrams kept
+    quint64 size = 0;
+    // Decisions of the adaptive policy, see DatagramPoolAdaptivePolicy
+    quint64 grows = 0;
+    quint64 shrinks = 0;
+
+    bool operator==(const DatagramPoolStatistics& other) const;
+    bool operator!=(const DatagramPoolStatistics& other) const;
+};
+
+// Let a DatagramPool size itself from the traffic, in DatagramPool::adapt.
+// The size of a class grows to the peak of datagrams in use observed since the previous adapt,
+// so the next burst is served without allocation.
+// When the peak stays below the size for 'idleTimeout', the size decays to that peak and free datagrams above are destroyed.
+struct DatagramPoolAdaptivePolicy
+{
+    bool enabled = false;
+    quint64 idleTimeout = 30000;
+    std::size_t minimumSize = 8;
+    std::size_t maximumSize = 4096;
+};
+
+// Recycle InlineDatagram to avoid dynamic allocation on the hot path.
+// When the last reference on a datagram is released, its block (control block + datagram + payload) isn't freed,
+// it is pushed on a lock-free return stack, whatever the thread releasing it.
+// The owner thread drain the whole return stack at once when a free list is empty, and rebuild datagrams in place.
+// make() only touch the owner free list when it isn't empty, without any lock or atomic operation.
+// The pool itself should only be used from a single thread, datagrams can be released from any thread.
+// Datagrams can outlive the pool, their block is then freed by their last owner.
+//
+// Blocks are segregated by size class, so a burst of big datagrams doesn't pin big buffers reused for small packets.
+// Every block of a class have the same capacity. Datagrams bigger than the last class are never recycled.
+class NETUDP_API_ DatagramPool
+{
+    // ────── TYPES ────────
+public:
+    enum SizeClass
+    {
+        Small, // Up to 256 bytes
+        Mtu, // Up to an ethernet MTU
+        Jumbo, // Up to a jumbo frame
+        Max, // Up to the biggest UDP datagram
+        SizeClassCount
+    };
+
+    // Backing memory of the arenas allocated by prewarm
+    enum HugePages
+    {
+        NoHugePages,
+        TransparentHugePages, // madvise(MADV_HUGEPAGE), Linux only
+        ExplicitHugePages, // mmap(MAP_HUGETLB) from the reserved huge pages, fallback to transparent huge pages. Linux only
+    };
+
+    // Capacity of every datagram of 'sizeClass'
+    static std::size_t capacity(SizeClass sizeClass);
+
+    // Smallest class that can hold 'length' bytes, SizeClassCount if none
+    static SizeClass sizeClass(std::size_t length);
+
+    // ────── CONSTRUCTOR ────────
+public:
+    DatagramPool(std::size_t size = 64);
+    ~DatagramPool();
+
+    DatagramPool(const DatagramPool&) = delete;
+    DatagramPool& operator=(const DatagramPool&) = delete;
+
+    // ────── API ────────
+public:
+    // Maximum number of free datagrams kept by each size class, as configured by resize(size).
+    // The adaptive policy doesn't change it, size(sizeClass) report the effective size of each class.
+    std::size_t size() const;
+    bool resize(std::size_t size);
+
+    // Effective size of 'sizeClass', follow the adaptive policy
+    std::size_t size(SizeClass sizeClass) const;
+    bool resize(SizeClass sizeClass, std::size_t size);
+
+    // Number of free datagrams ready to be reused in 'sizeClass'
+    std::size_t freeCount(SizeClass sizeClass) const;
+
+    HugePages hugePages() const;
+    void setHugePages(HugePages hugePages);
+
+    const DatagramPoolAdaptivePolicy& adaptivePolicy() const;
+    void setAdaptivePolicy(const DatagramPoolAdaptivePolicy& policy);
+
+    // Apply the adaptive policy, 'elapsed' milliseconds after the previous call. Do nothing if the policy is disabled.
+    void adapt(quint64 elapsed);
+
+    // Allocate free datagrams in 'sizeClass' until 'count' are free, bounded by size(sizeClass).
+    // Every new datagram is carved from a single arena whose pages are faulted immediately.
+    // Return the number of datagrams allocated.
+    std::size_t prewarm(SizeClass sizeClass, std::size_t count);
+
+    // Allocate up to 'count' free datagrams in every size class
+    std::size_t prewarm(std::size_t count);
+
+    // Destroy every free datagram. Datagrams in use will be recycled when released.
+    void clear();
+
+    // Destroy every free datagram, including the one that were released but not yet given back to the owner.
+    void release();
+
+    // Return a datagram of 'length' bytes, recycled if possible
+    std::shared_ptr<InlineDatagram> make(std::size_t length);
+
+    // Counters of the whole pool
+    DatagramPoolStatistics statistics() const;
+
+    // Counters of a single size class. SizeClassCount report datagrams bigger than the last class.
+    DatagramPoolStatistics statistics(SizeClass sizeClass) const;
+
+private:
+    struct Pool
+    {
+        std::vector<DatagramPoolBlock*> free;
+        std::size_t size = 0;
+
+        // Adaptive policy state
+        quint64 windowPeakInUse = 0;
+        quint64 quietPeakInUse = 0;
+        quint64 quietTime = 0;
+    };
+
+    // Move every block released by other owners to the free list of its class
+    void drain();
+    void trim(Pool& pool);
+    void destroy(DatagramPoolBlock* block);
+
+    // Only touched by the owner thread, releases are counted by the core
+    struct Counters
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 peakInUse = 0;
+        quint64 bytesReserved = 0;
+        quint64 grows = 0;
+        quint64 shrinks = 0;
+    };
+
+    DatagramPoolCore* _core = nullptr;
+    std::array<Pool, SizeClassCount> _pools;
+    std::array<Counters, SizeClassCount + 1> _counters;
+    quint64 _made = 0;
+    quint64 _peakInUse = 0;
+    std::size_t _size = 0;
+    HugePages _hugePages = NoHugePages;
+    DatagramPoolAdaptivePolicy _adaptivePolicy;
+};
+
+}
+
+Q_DECLARE_METATYPE(netudp::DatagramPoolStatistics);
+Q_DECLARE_METATYPE(netudp::DatagramPool::HugePages);
+
+#endif
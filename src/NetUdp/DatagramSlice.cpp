@@ -0,0 +1,112 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <NetUdp/DatagramSlice.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace netudp {
+
+DatagramSlice::DatagramSlice(PrivateTag, SharedDatagram parent, std::size_t offset, std::size_t length)
+    : _parent(std::move(parent))
+    , _offset(offset)
+{
+    destinationAddress = _parent->destinationAddress;
+    destinationPort = _parent->destinationPort;
+    senderAddress = _parent->senderAddress;
+    senderPort = _parent->senderPort;
+    ttl = _parent->ttl;
+
+    resize(length);
+}
+
+std::shared_ptr<DatagramSlice> DatagramSlice::make(SharedDatagram parent, std::size_t offset, std::size_t length)
+{
+    if(!parent)
+        return nullptr;
+
+    // Avoid chains of slices, only one indirection to reach the buffer
+    if(const auto* const slice = dynamic_cast<const DatagramSlice*>(parent.get()))
+    {
+        const auto sliceLength = slice->length();
+        offset = std::min(offset, sliceLength);
+        length = std::min(length, sliceLength - offset);
+        offset += slice->_offset;
+        parent = slice->_parent;
+    }
+
+    offset = std::min(offset, parent->length());
+    return std::make_shared<DatagramSlice>(PrivateTag(), std::move(parent), offset, length);
+}
+
+std::shared_ptr<DatagramSlice> DatagramSlice::make(SharedDatagram parent, std::size_t offset)
+{
+    const auto length = parent ? parent->length() : 0;
+    return make(std::move(parent), offset, length > offset ? length - offset : 0);
+}
+
+void DatagramSlice::reset()
+{
+    _parent.reset();
+    _offset = 0;
+    _length = 0;
+    Datagram::reset();
+}
+
+void DatagramSlice::reset(std::size_t length)
+{
+    resize(length);
+    Datagram::reset(length);
+}
+
+void DatagramSlice::resize(std::size_t length)
+{
+    _length = std::min(length, available());
+}
+
+std::uint8_t* DatagramSlice::buffer()
+{
+    return _parent ? _parent->buffer() + _offset : nullptr;
+}
+
+const std::uint8_t* DatagramSlice::buffer() const
+{
+    if(!_parent)
+        return nullptr;
+
+    // Const access to never detach implicitly shared data of the parent
+    const auto* const parentBuffer = std::as_const(*_parent).buffer();
+    return parentBuffer ? parentBuffer + _offset : nullptr;
+}
+
+std::size_t DatagramSlice::length() const
+{
+    // The parent might have been resized since
+    return std::min(_length, available());
+}
+
+const SharedDatagram& DatagramSlice::parent() const
+{
+    return _parent;
+}
+
+std::size_t DatagramSlice::offset() const
+{
+    return _offset;
+}
+
+std::size_t DatagramSlice::available() const
+{
+    if(!_parent)
+        return 0;
+
+    const auto parentLength = _parent->length();
+    return parentLength > _offset ? parentLength - _offset : 0;
+}
+
+}
@@ -0,0 +1,65 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_DATAGRAM_SLICE_HPP__
+#define __NETUDP_DATAGRAM_SLICE_HPP__
+
+#include <NetUdp/Datagram.hpp>
+
+namespace netudp {
+
+// View over 'length' bytes at 'offset' of a parent datagram, without copy. The parent is kept alive by the slice.
+// Can be used anywhere a SharedDatagram is expected, for example to forward one sub message of a received datagram.
+// Writing through a slice write in the parent.
+// The attributes are copied from the parent when the slice is made, they can then be changed independently.
+class NETUDP_API_ DatagramSlice final : public Datagram
+{
+    struct PrivateTag
+    {
+    };
+
+    // ────── CONSTRUCTOR ────────
+public:
+    // Only callable through 'make'
+    DatagramSlice(PrivateTag, SharedDatagram parent, std::size_t offset, std::size_t length);
+
+    // Slice 'parent' from 'offset' to 'offset + length'. The slice is clamped to the parent length.
+    // Slicing a slice reference the original parent directly.
+    // Return nullptr if 'parent' is null.
+    static std::shared_ptr<DatagramSlice> make(SharedDatagram parent, std::size_t offset, std::size_t length);
+
+    // Slice 'parent' from 'offset' to its end
+    static std::shared_ptr<DatagramSlice> make(SharedDatagram parent, std::size_t offset);
+
+    // Detach from the parent, the slice is then empty
+    void reset() override;
+
+    // A slice can't grow beyond its parent, 'length' is clamped. The content isn't cleared.
+    void reset(std::size_t length) override;
+    void resize(std::size_t length) override;
+
+    // ────── API ────────
+public:
+    std::uint8_t* buffer() override;
+    const std::uint8_t* buffer() const override;
+    std::size_t length() const override;
+
+    const SharedDatagram& parent() const;
+    std::size_t offset() const;
+
+private:
+    std::size_t available() const;
+
+    SharedDatagram _parent;
+    std::size_t _offset = 0;
+    std::size_t _length = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,149 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_FIXED_DATAGRAM_HPP__
+#define __NETUDP_FIXED_DATAGRAM_HPP__
+
+#include <NetUdp/Datagram.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace netudp {
+
+// Datagram that can hold up to N bytes in an inline std::array.
+// Made with std::make_shared, the control block, the attributes and the payload share a single allocation.
+// The class is final, so calls through a FixedDatagram<N> are devirtualized.
+template<std::size_t N>
+class FixedDatagram final : public Datagram
+{
+    // ────── CONSTRUCTOR ────────
+public:
+    FixedDatagram(std::size_t length = 0)
+    {
+        resize(length);
+    }
+
+    void reset() override final
+    {
+        _length = 0;
+        Datagram::reset();
+    }
+
+    void reset(std::size_t length) override final
+    {
+        resize(length);
+        Datagram::reset(length);
+    }
+
+    // 'length' is bounded to N
+    void resize(std::size_t length) override final
+    {
+        Q_ASSERT(length <= N);
+        _length = length < N ? length : N;
+    }
+
+    // ────── API ────────
+public:
+    std::uint8_t* buffer() override final
+    {
+        return _buffer.data();
+    }
+
+    const std::uint8_t* buffer() const override final
+    {
+        return _buffer.data();
+    }
+
+    std::size_t length() const override final
+    {
+        return _length;
+    }
+
+    std::size_t capacity() const override final
+    {
+        return N;
+    }
+
+private:
+    std::size_t _length = 0;
+    std::array<std::uint8_t, N> _buffer;
+};
+
+// Recycle FixedDatagram<N>, a datagram is free again when the pool is its only owner.
+// The pool should only be used from a single thread, datagrams can be released from any thread.
+template<std::size_t N>
+class FixedDatagramPool
+{
+    // ────── CONSTRUCTOR ────────
+public:
+    FixedDatagramPool(std::size_t size = 64)
+        : _size(size)
+    {
+    }
+
+    // ────── API ────────
+public:
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+    void resize(std::size_t size)
+    {
+        _size = size;
+        if(_datagrams.size() > _size)
+            _datagrams.resize(_size);
+        if(_next >= _datagrams.size())
+            _next = 0;
+    }
+
+    void clear()
+    {
+        _datagrams.clear();
+        _next = 0;
+    }
+
+    // Return nullptr when 'length' is bigger than N
+    std::shared_ptr<FixedDatagram<N>> make(std::size_t length)
+    {
+        if(length > N)
+            return nullptr;
+
+        const auto count = _datagrams.size();
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const auto index = (_next + i) % count;
+            auto& datagram = _datagrams[index];
+            if(datagram.use_count() != 1)
+                continue;
+
+            // Synchronize with a release that might have happened on another thread
+            std::atomic_thread_fence(std::memory_order_acquire);
+            _next = (index + 1) % count;
+            datagram->reset(length);
+            return datagram;
+        }
+
+        auto datagram = std::make_shared<FixedDatagram<N>>(length);
+        if(count < _size)
+            _datagrams.push_back(datagram);
+        return datagram;
+    }
+
+private:
+    std::vector<std::shared_ptr<FixedDatagram<N>>> _datagrams;
+    std::size_t _size = 0;
+    std::size_t _next = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_FIXED_DATAGRAM_SOCKET_HPP__
+#define __NETUDP_FIXED_DATAGRAM_SOCKET_HPP__
+
+#include <NetUdp/FixedDatagram.hpp>
+#include <NetUdp/Socket.hpp>
+#include <NetUdp/Worker.hpp>
+
+namespace netudp {
+
+// Worker that receive datagrams up to N bytes in recycled FixedDatagram<N>.
+// Bigger datagrams fallback to Worker::makeDatagram.
+template<std::size_t N>
+class FixedDatagramWorker : public Worker
+{
+    // ────── CONSTRUCTOR ────────
+public:
+    using Worker::Worker;
+
+    // ────── API ────────
+public:
+    std::shared_ptr<Datagram> makeDatagram(const size_t length) override
+    {
+        if(length > N)
+            return Worker::makeDatagram(length);
+
+        // Follow resizeCache
+        if(_cache.size() != cacheSize())
+            _cache.resize(cacheSize());
+        return _cache.make(length);
+    }
+
+private:
+    FixedDatagramPool<N> _cache;
+};
+
+// Socket that send and receive datagrams up to N bytes with FixedDatagram<N>.
+// For MTU bounded traffic, use FixedDatagramSocket<1500>: datagrams are recycled and never allocated on the hot path.
+template<std::size_t N>
+class FixedDatagramSocket : public Socket
+{
+    // ────── CONSTRUCTOR ────────
+public:
+    using Socket::Socket;
+
+    // ──────── CUSTOM WORKER API ────────
+protected:
+    Worker* createWorker() override
+    {
+        return new FixedDatagramWorker<N>;
+    }
+
+    // ──────── CUSTOM DATAGRAM API ────────
+public:
+    std::shared_ptr<Datagram> makeDatagram(const size_t length) override
+    {
+        if(length > N)
+            return Socket::makeDatagram(length);
+        return _cache.make(length);
+    }
+
+    // Statically typed datagram, nullptr when 'length' is bigger than N: use makeDatagram for those.
+    // Serializing through it doesn't involve any virtual call.
+    std::shared_ptr<FixedDatagram<N>> makeFixedDatagram(const size_t length)
+    {
+        return _cache.make(length);
+    }
+
+private:
+    FixedDatagramPool<N> _cache;
+};
+
+}
+
+#endif
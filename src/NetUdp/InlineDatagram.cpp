@@ -0,0 +1,71 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <NetUdp/InlineDatagram.hpp>
+#include <cstring>
+
+namespace netudp {
+
+InlineDatagram::InlineDatagram(PrivateTag, std::uint8_t* const* payload, std::size_t capacity)
+    : _payload(*payload)
+    , _capacity(capacity)
+    , _length(capacity)
+{
+    Q_CHECK_PTR(_payload);
+}
+
+// 'make' is defined in DatagramPool.cpp, to share DatagramPoolAllocator
+
+void InlineDatagram::reset()
+{
+    _overflow.reset();
+    _length = 0;
+    Datagram::reset();
+}
+
+void InlineDatagram::reset(std::size_t length)
+{
+    _overflow.reset();
+    _length = 0;
+    resize(length);
+    Datagram::reset(length);
+}
+
+void InlineDatagram::resize(std::size_t length)
+{
+    if(length > _capacity && (!_overflow || length > _length))
+    {
+        auto overflow = std::make_unique<std::uint8_t[]>(length);
+        if(_length)
+            std::memcpy(overflow.get(), buffer(), _length);
+        _overflow = std::move(overflow);
+    }
+    _length = length;
+}
+
+std::uint8_t* InlineDatagram::buffer()
+{
+    return _overflow ? _overflow.get() : _payload;
+}
+
+const std::uint8_t* InlineDatagram::buffer() const
+{
+    return _overflow ? _overflow.get() : _payload;
+}
+
+std::size_t InlineDatagram::length() const
+{
+    return _length;
+}
+
+std::size_t InlineDatagram::capacity() const
+{
+    return _capacity;
+}
+
+}
@@ -0,0 +1,65 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_INLINE_DATAGRAM_HPP__
+#define __NETUDP_INLINE_DATAGRAM_HPP__
+
+#include <NetUdp/Datagram.hpp>
+#include <cstdint>
+#include <memory>
+
+namespace netudp {
+
+// Datagram whose shared_ptr control block, attributes and payload live in a single cache line aligned allocation.
+// [ control block | InlineDatagram | padding ][ payload ... ]
+// ^ aligned on 'alignment'                    ^ aligned on 'alignment'
+// Reading the attributes and then the payload doesn't chase pointers across the heap.
+class NETUDP_API_ InlineDatagram final : public Datagram
+{
+    struct PrivateTag
+    {
+    };
+    friend class DatagramPool;
+
+    // ────── CONSTRUCTOR ────────
+public:
+    // Only callable through 'make' and DatagramPool
+    InlineDatagram(PrivateTag, std::uint8_t* const* payload, std::size_t capacity);
+
+    // Allocate a datagram that can hold 'capacity' bytes without any other allocation.
+    static std::shared_ptr<InlineDatagram> make(std::size_t capacity);
+
+    void reset() override;
+    void reset(std::size_t length) override;
+
+    // Resizing above 'capacity' move the payload to a separate heap buffer.
+    void resize(std::size_t length) override;
+
+    // ────── API ────────
+public:
+    std::uint8_t* buffer() override;
+    const std::uint8_t* buffer() const override;
+    std::size_t length() const override;
+
+    // Number of bytes available in the inline payload
+    std::size_t capacity() const override;
+
+    static constexpr std::size_t alignment = 64;
+
+private:
+    std::uint8_t* _payload = nullptr;
+    std::size_t _capacity = 0;
+    std::size_t _length = 0;
+
+    // Only used when the datagram is resized above its inline capacity
+    std::unique_ptr<std::uint8_t[]> _overflow;
+};
+
+}
+
+#endif
@@ -0,0 +1,171 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <NetUdp/InterfacesMonitor.hpp>
+#include <NetUdp/InterfacesProvider.hpp>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QDebug>
+#include <mutex>
+
+#ifdef Q_OS_LINUX
+#    include <sys/socket.h>
+#    include <linux/netlink.h>
+#    include <linux/rtnetlink.h>
+#    include <unistd.h>
+#    include <cerrno>
+#    include <cstring>
+#endif
+
+Q_LOGGING_CATEGORY(netudp_monitor_log, "netudp.monitor");
+
+namespace netudp {
+
+static std::mutex interfacesMonitorMutex;
+static InterfacesMonitor* interfacesMonitor = nullptr;
+
+InterfacesMonitor::InterfacesMonitor() = default;
+
+InterfacesMonitor::~InterfacesMonitor()
+{
+    close();
+}
+
+InterfacesMonitor* InterfacesMonitor::instance()
+{
+    std::lock_guard<std::mutex> lock(interfacesMonitorMutex);
+    if(interfacesMonitor)
+        return interfacesMonitor;
+
+    auto* const app = QCoreApplication::instance();
+    if(!app)
+        return nullptr;
+
+    // Workers live in any thread and come and go, the application thread outlive all of them.
+    interfacesMonitor = new InterfacesMonitor();
+    interfacesMonitor->moveToThread(app->thread());
+    QMetaObject::invokeMethod(interfacesMonitor, "open", Qt::QueuedConnection);
+    QObject::connect(app,
+        &QObject::destroyed,
+        []()
+        {
+            std::lock_guard<std::mutex> lock(interfacesMonitorMutex);
+            delete interfacesMonitor;
+            interfacesMonitor = nullptr;
+        });
+
+    return interfacesMonitor;
+}
+
+bool InterfacesMonitor::isActive() const
+{
+    return _active.load(std::memory_order_relaxed);
+}
+
+void InterfacesMonitor::open()
+{
+#ifdef Q_OS_LINUX
+    if(_descriptor != -1)
+        return;
+
+    _descriptor = ::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if(_descriptor == -1)
+    {
+        qCWarning(netudp_monitor_log) << "Fail to open rtnetlink socket, interfaces are only polled : " << qt_error_string(errno);
+        return;
+    }
+
+    sockaddr_nl address;
+    std::memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+    if(::bind(_descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1)
+    {
+        qCWarning(netudp_monitor_log) << "Fail to bind rtnetlink socket, interfaces are only polled : " << qt_error_string(errno);
+        close();
+        return;
+    }
+
+    _notifier = new QSocketNotifier(_descriptor, QSocketNotifier::Read, this);
+    connect(_notifier, &QSocketNotifier::activated, this, &InterfacesMonitor::readEvents);
+    _active = true;
+    Q_EMIT activeChanged(true);
+
+    qCDebug(netudp_monitor_log) << "Listen to rtnetlink interface events";
+#endif
+}
+
+void InterfacesMonitor::close()
+{
+    if(_active.exchange(false))
+        Q_EMIT activeChanged(false);
+
+    delete _notifier;
+    _notifier = nullptr;
+
+#ifdef Q_OS_LINUX
+    if(_descriptor != -1)
+        ::close(_descriptor);
+#endif
+    _descriptor = -1;
+}
+
+void InterfacesMonitor::readEvents()
+{
+#ifdef Q_OS_LINUX
+    bool changed = false;
+
+    // Drain the socket, a link flap generate a bunch of messages that are reported once.
+    alignas(nlmsghdr) char buffer[8192];
+    for(;;)
+    {
+        const auto length = ::recv(_descriptor, buffer, sizeof(buffer), 0);
+        if(length < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            // Some events were lost, consider that everything changed
+            if(errno == ENOBUFS)
+                changed = true;
+            else if(errno != EAGAIN && errno != EWOULDBLOCK)
+                qCWarning(netudp_monitor_log) << "Fail to read rtnetlink socket : " << qt_error_string(errno);
+            break;
+        }
+
+        auto remaining = std::uint32_t(length);
+        const auto* header = reinterpret_cast<const nlmsghdr*>(buffer);
+        for(; NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining))
+        {
+            switch(header->nlmsg_type)
+            {
+            case RTM_NEWLINK:
+            case RTM_DELLINK:
+            case RTM_NEWADDR:
+            case RTM_DELADDR:
+                changed = true;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    if(!changed)
+        return;
+
+    qCDebug(netudp_monitor_log) << "Interfaces changed";
+    InterfacesProvider::invalidateCache();
+    Q_EMIT interfacesChanged();
+#endif
+}
+
+}
+
+#include "moc_InterfacesMonitor.cpp"
@@ -0,0 +1,64 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_INTERFACES_MONITOR_HPP__
+#define __NETUDP_INTERFACES_MONITOR_HPP__
+
+#include <NetUdp/Export.hpp>
+#include <QtCore/QObject>
+#include <atomic>
+
+QT_FORWARD_DECLARE_CLASS(QSocketNotifier);
+
+namespace netudp {
+
+// Push network interface changes to every worker of the process, instead of waiting for their watcher timers.
+// On Linux, listen to rtnetlink link and address events (RTMGRP_LINK, RTMGRP_IPV4_IFADDR, RTMGRP_IPV6_IFADDR).
+// On other platforms the monitor is never active, and workers rely on their timers only.
+class NETUDP_API_ InterfacesMonitor : public QObject
+{
+    Q_OBJECT
+
+    // ────── CONSTRUCTOR ────────
+private:
+    InterfacesMonitor();
+
+public:
+    ~InterfacesMonitor() override;
+
+    // Shared by every worker, lives in the QCoreApplication thread and is destroyed with it.
+    // Return nullptr when there is no QCoreApplication.
+    static InterfacesMonitor* instance();
+
+    // ────── API ────────
+public:
+    // True once the kernel events are received. Can be called from any thread.
+    bool isActive() const;
+
+Q_SIGNALS:
+    // A link or an address appeared, disappeared or changed state.
+    // Events read at once are coalesced, and InterfacesProvider cache is invalidated before the emission.
+    void interfacesChanged();
+
+    // The monitor started or stopped receiving kernel events, see isActive.
+    void activeChanged(bool active);
+
+private Q_SLOTS:
+    void open();
+    void close();
+    void readEvents();
+
+private:
+    int _descriptor = -1;
+    QSocketNotifier* _notifier = nullptr;
+    std::atomic<bool> _active = {false};
+};
+
+}
+
+#endif
@@ -9,11 +9,64 @@
 #include <NetUdp/InterfacesProvider.hpp>
 #include <QtNetwork/QNetworkInterface>
 #include <QtNetwork/QNetworkAddressEntry>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <mutex>
 
 namespace netudp {
 
+InterfacesSnapshot::InterfacesSnapshot(InterfacePtrList interfaces, quint64 generation)
+    : _interfaces(std::move(interfaces))
+    , _generation(generation)
+{
+    _byName.reserve(int(_interfaces.size()));
+    _byIndex.reserve(int(_interfaces.size()));
+    for(const auto& iface: _interfaces)
+    {
+        Q_CHECK_PTR(iface);
+        _byName.insert(iface->name(), iface);
+        if(iface->index() > 0)
+            _byIndex.insert(iface->index(), iface);
+    }
+}
+
+const InterfacePtrList& InterfacesSnapshot::interfaces() const
+{
+    return _interfaces;
+}
+
+quint64 InterfacesSnapshot::generation() const
+{
+    return _generation;
+}
+
+InterfacePtr InterfacesSnapshot::fromName(const QString& name) const
+{
+    return _byName.value(name);
+}
+
+InterfacePtr InterfacesSnapshot::fromIndex(int index) const
+{
+    return _byIndex.value(index);
+}
+
+InterfacePtrList::const_iterator InterfacesSnapshot::begin() const
+{
+    return _interfaces.begin();
+}
+
+InterfacePtrList::const_iterator InterfacesSnapshot::end() const
+{
+    return _interfaces.end();
+}
+
+InterfacesSnapshotPtr InterfacesProvider::IProvider::snapshot(bool allowCache) const
+{
+    static std::atomic<quint64> generation = {0};
+    return std::make_shared<const InterfacesSnapshot>(allInterfaces(allowCache), ++generation);
+}
+
 class QRealNetworkIface : public IInterface
 {
 public:
@@ -55,6 +108,19 @@ public:
     {
         return _iface.flags() & QNetworkInterface::CanMulticast;
     }
+    int index() const override
+    {
+        return _iface.index();
+    }
+    QHostAddress ipv4Address() const override
+    {
+        for(const auto& entry: _iface.addressEntries())
+        {
+            if(entry.ip().protocol() == QAbstractSocket::IPv4Protocol)
+                return entry.ip();
+        }
+        return {};
+    }
 
 private:
     QNetworkInterface _iface;
@@ -66,6 +132,67 @@ public:
     }
 };
 
+// Interface that isn't present anymore (or not yet), answered without asking the os again.
+class QMissingNetworkIface : public IInterface
+{
+public:
+    QMissingNetworkIface(const QString& name)
+        : _name(name)
+    {
+    }
+
+    bool isValid() const override
+    {
+        return false;
+    }
+    QString name() const override
+    {
+        return _name;
+    }
+
+    bool isUp() const override
+    {
+        return false;
+    }
+    bool isRunning() const override
+    {
+        return false;
+    }
+    bool canBroadcast() const override
+    {
+        return false;
+    }
+    bool isLoopBack() const override
+    {
+        return false;
+    }
+    bool isPointToPoint() const override
+    {
+        return false;
+    }
+    bool canMulticast() const override
+    {
+        return false;
+    }
+
+private:
+    QString _name;
+};
+
+static bool interfacesProviderSameInterfaces(const InterfacePtrList& lhs, const InterfacePtrList& rhs)
+{
+    const auto sameInterface = [](const InterfacePtr& l, const InterfacePtr& r)
+    {
+        return l->name() == r->name() && l->index() == r->index() && l->isValid() == r->isValid() && l->isUp() == r->isUp()
+               && l->isRunning() == r->isRunning() && l->canBroadcast() == r->canBroadcast() && l->isLoopBack() == r->isLoopBack()
+               && l->isPointToPoint() == r->isPointToPoint() && l->canMulticast() == r->canMulticast()
+               && l->ipv4Address() == r->ipv4Address();
+    };
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), sameInterface);
+}
+
+// Snapshots are published RCU style: readers atomically load the current one, and never wait for a refresh in progress.
+// Only the thread refreshing an expired snapshot enumerate the interfaces, the others keep using the previous one.
 class QRealNetworkIFaceProvider : public InterfacesProvider::IProvider
 {
 public:
@@ -74,50 +201,77 @@ public:
         return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
     }
 
-    mutable std::uint64_t lastCacheFetch = 0;
-    mutable InterfacePtrList cache;
-    mutable bool fetchedOnce = false;
-    mutable std::mutex mutex;
+    static constexpr std::uint64_t cacheTimeout = 3000;
 
-    [[nodiscard]] InterfacePtrList allInterfaces(bool allowCache) const override
+    // Read through std::atomic_load/std::atomic_store only
+    mutable InterfacesSnapshotPtr published;
+    // Time in ms after which 'published' need to be refreshed. 0 when invalidated.
+    mutable std::atomic<std::uint64_t> expiry = {0};
+    // Incremented by invalidateCache, so a refresh that started before an invalidation doesn't mark its result as fresh
+    mutable std::atomic<std::uint64_t> invalidations = {0};
+    // Serialize refreshes
+    mutable std::mutex refreshMutex;
+
+    [[nodiscard]] InterfacesSnapshotPtr snapshot(bool allowCache) const override
     {
-        mutex.lock();
-        const auto ms = now();
-        if(allowCache && fetchedOnce && (ms - lastCacheFetch) < 3000)
+        if(allowCache && now() < expiry.load())
+            return std::atomic_load(&published);
+
+        std::unique_lock<std::mutex> lock(refreshMutex, std::defer_lock);
+        if(allowCache)
+        {
+            // Someone else is refreshing, the current snapshot is good enough
+            if(!lock.try_lock())
+            {
+                if(auto current = std::atomic_load(&published))
+                    return current;
+                lock.lock();
+            }
+
+            // Refreshed while we were waiting
+            if(now() < expiry.load())
+                return std::atomic_load(&published);
+        }
+        else
         {
-            mutex.unlock();
-            return cache;
+            lock.lock();
         }
 
-        InterfacePtrList result;
+        const auto invalidationsBeforeRefresh = invalidations.load();
+
+        InterfacePtrList interfaces;
         for(const auto& iface: QNetworkInterface::allInterfaces())
         {
-            result.push_back(QRealNetworkIface::make(iface));
+            interfaces.push_back(QRealNetworkIface::make(iface));
         }
-        cache = result;
-        fetchedOnce = true;
-        lastCacheFetch = ms;
 
-        mutex.unlock();
-        return result;
-    }
-    [[nodiscard]] InterfacePtr interfaceFromName(const QString& name, bool allowCache) const override
-    {
-        mutex.lock();
-        if(allowCache && fetchedOnce && (now() - lastCacheFetch) < 3000)
+        // Keep the current snapshot when nothing changed, so its generation stay the same
+        auto current = std::atomic_load(&published);
+        if(!current || !interfacesProviderSameInterfaces(current->interfaces(), interfaces))
         {
-            for(const auto& iface: cache)
-            {
-                if(iface->name() == name)
-                {
-                    mutex.unlock();
-                    return iface;
-                }
-            }
+            current = std::make_shared<const InterfacesSnapshot>(std::move(interfaces), current ? current->generation() + 1 : 1);
+            std::atomic_store(&published, current);
         }
+        expiry.store(now() + cacheTimeout);
+        if(invalidations.load() != invalidationsBeforeRefresh)
+            expiry.store(0);
 
-        mutex.unlock();
-        return QRealNetworkIface::make(QNetworkInterface::interfaceFromName(name));
+        return current;
+    }
+    [[nodiscard]] InterfacePtrList allInterfaces(bool allowCache) const override
+    {
+        return snapshot(allowCache)->interfaces();
+    }
+    [[nodiscard]] InterfacePtr interfaceFromName(const QString& name, bool allowCache) const override
+    {
+        if(auto iface = snapshot(allowCache)->fromName(name))
+            return iface;
+        return std::make_shared<QMissingNetworkIface>(name);
+    }
+    void invalidateCache() override
+    {
+        invalidations.fetch_add(1);
+        expiry.store(0);
     }
 };
 
@@ -142,10 +296,22 @@ InterfacePtr InterfacesProvider::interfaceFromName(const QString& name, bool all
     return _provider->interfaceFromName(name, allowCache);
 }
 
+InterfacesSnapshotPtr InterfacesProvider::snapshot(bool allowCache)
+{
+    Q_ASSERT(_provider);
+    return _provider->snapshot(allowCache);
+}
+
+void InterfacesProvider::invalidateCache()
+{
+    Q_ASSERT(_provider);
+    _provider->invalidateCache();
+}
+
 void InterfacesProviderSingleton::fetchInterfaces()
 {
     QStringList result;
-    for(const auto& interface: InterfacesProvider::allInterfaces())
+    for(const auto& interface: *InterfacesProvider::snapshot())
     {
         if(interface->isValid() && interface->isRunning() && interface->isUp() && interface->canMulticast())
             result.push_back(interface->name());
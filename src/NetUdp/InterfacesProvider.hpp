@@ -12,6 +12,8 @@
 #include <NetUdp/Export.hpp>
 #include <NetUdp/Property.hpp>
 #include <QtCore/QString>
+#include <QtCore/QHash>
+#include <QtNetwork/QHostAddress>
 #include <memory>
 #include <vector>
 
@@ -34,11 +36,49 @@ public:
     virtual bool isLoopBack() const = 0;
     virtual bool isPointToPoint() const = 0;
     virtual bool canMulticast() const = 0;
+
+    // Os index of the interface (ifindex), 0 if unknown.
+    virtual int index() const
+    {
+        return 0;
+    }
+
+    // First IPv4 address of the interface, null if unknown.
+    virtual QHostAddress ipv4Address() const
+    {
+        return {};
+    }
 };
 
 using InterfacePtr = std::shared_ptr<const IInterface>;
 using InterfacePtrList = std::vector<InterfacePtr>;
 
+// Immutable list of interfaces, indexed by name and by os index.
+// 'generation' change only when the interfaces or their flags changed, so a consumer can skip work when it didn't.
+class NETUDP_API_ InterfacesSnapshot
+{
+public:
+    InterfacesSnapshot(InterfacePtrList interfaces, quint64 generation);
+
+    const InterfacePtrList& interfaces() const;
+    quint64 generation() const;
+
+    // Return nullptr if not present in the snapshot
+    InterfacePtr fromName(const QString& name) const;
+    InterfacePtr fromIndex(int index) const;
+
+    InterfacePtrList::const_iterator begin() const;
+    InterfacePtrList::const_iterator end() const;
+
+private:
+    InterfacePtrList _interfaces;
+    QHash<QString, InterfacePtr> _byName;
+    QHash<int, InterfacePtr> _byIndex;
+    quint64 _generation = 0;
+};
+
+using InterfacesSnapshotPtr = std::shared_ptr<const InterfacesSnapshot>;
+
 class NETUDP_API_ InterfacesProvider
 {
     // ──── TYPES ────
@@ -49,6 +89,14 @@ public:
         virtual ~IProvider() = default;
         virtual InterfacePtrList allInterfaces(bool allowCache = true) const = 0;
         virtual InterfacePtr interfaceFromName(const QString& name, bool allowCache = true) const = 0;
+
+        // Default implementation index 'allInterfaces', and consider every snapshot as a new generation.
+        virtual InterfacesSnapshotPtr snapshot(bool allowCache = true) const;
+
+        // Called when interfaces are known to have changed, the next call shouldn't be served from a cache.
+        virtual void invalidateCache()
+        {
+        }
     };
     using ProviderPtr = std::unique_ptr<IProvider>;
 
@@ -57,6 +105,8 @@ public:
     static void setProvider(ProviderPtr p);
     static InterfacePtrList allInterfaces(bool allowCache = true);
     static InterfacePtr interfaceFromName(const QString& name, bool allowCache = true);
+    static InterfacesSnapshotPtr snapshot(bool allowCache = true);
+    static void invalidateCache();
 
 private:
     static ProviderPtr _provider;
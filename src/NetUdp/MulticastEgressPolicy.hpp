@@ -0,0 +1,31 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef __NETUDP_MULTICAST_EGRESS_POLICY_HPP__
+#define __NETUDP_MULTICAST_EGRESS_POLICY_HPP__
+
+#include <QtCore/QMetaType>
+
+namespace netudp {
+
+// Interfaces a multicast datagram is written on, among the ones that have a multicast tx socket.
+// See Socket::multicastOutgoingInterfaces for the interfaces that get a socket.
+// Groups with explicit interfaces (Socket::setMulticastEgressInterfaces) ignore the policy.
+enum class MulticastEgressPolicy
+{
+    AllInterfaces, // Every interface, a datagram is written once per interface
+    RouteTable, // Interface of the kernel route to the group (netlink, Linux only). Every interface when there is no route
+    FirstHealthy, // First interface, by name, on which the last write didn't fail
+};
+
+}
+
+Q_DECLARE_METATYPE(netudp::MulticastEgressPolicy);
+
+#endif
@@ -0,0 +1,197 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <NetUdp/MulticastTxSocketPool.hpp>
+#include <NetUdp/InterfacesMonitor.hpp>
+#include <NetUdp/InterfacesProvider.hpp>
+#include <NetUdp/NativeSocket.hpp>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QDebug>
+#include <QtNetwork/QHostAddress>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+Q_LOGGING_CATEGORY(netudp_tx_pool_log, "netudp.txpool");
+
+namespace netudp {
+
+struct MulticastTxSocketKey
+{
+    QString interfaceName;
+    int interfaceIndex;
+    quint8 ttl;
+    bool loopback;
+
+    bool operator<(const MulticastTxSocketKey& other) const
+    {
+        return std::tie(interfaceName, interfaceIndex, ttl, loopback)
+               < std::tie(other.interfaceName, other.interfaceIndex, other.ttl, other.loopback);
+    }
+};
+
+struct MulticastTxSocketEntry
+{
+    qintptr descriptor = -1;
+    std::size_t borrowers = 0;
+};
+
+// Sockets outlive the instance, workers can still release them after the QCoreApplication is destroyed
+static std::mutex multicastTxSocketsMutex;
+static std::map<MulticastTxSocketKey, MulticastTxSocketEntry> multicastTxSockets;
+
+static std::mutex multicastTxSocketPoolMutex;
+static std::shared_ptr<MulticastTxSocketPool> multicastTxSocketPool;
+
+MulticastTxSocketPool::MulticastTxSocketPool() = default;
+
+MulticastTxSocketPool::~MulticastTxSocketPool() = default;
+
+std::shared_ptr<MulticastTxSocketPool> MulticastTxSocketPool::instance()
+{
+    std::lock_guard<std::mutex> lock(multicastTxSocketPoolMutex);
+    if(multicastTxSocketPool)
+        return multicastTxSocketPool;
+
+    auto* const app = QCoreApplication::instance();
+    if(!app)
+        return nullptr;
+
+    // The last reference can be dropped by a worker, from its own thread
+    multicastTxSocketPool = std::shared_ptr<MulticastTxSocketPool>(new MulticastTxSocketPool(),
+        [](MulticastTxSocketPool* pool)
+        {
+            if(pool->thread() == QThread::currentThread())
+                delete pool;
+            else
+                pool->deleteLater();
+        });
+    multicastTxSocketPool->moveToThread(app->thread());
+
+    // The timer is slower while the monitor push interfaces events
+    if(auto* const monitor = InterfacesMonitor::instance())
+        QObject::connect(monitor, &InterfacesMonitor::activeChanged, multicastTxSocketPool.get(), &MulticastTxSocketPool::updateTimer);
+
+    QObject::connect(app,
+        &QObject::destroyed,
+        []()
+        {
+            std::lock_guard<std::mutex> lock(multicastTxSocketPoolMutex);
+
+            // The timer can't outlive the event loop, workers still watching only keep an idle instance
+            delete multicastTxSocketPool->_timer;
+            multicastTxSocketPool->_timer = nullptr;
+            multicastTxSocketPool.reset();
+        });
+
+    return multicastTxSocketPool;
+}
+
+qintptr MulticastTxSocketPool::acquire(const IInterface& iface, quint8 ttl, bool loopback, QString* error)
+{
+    const MulticastTxSocketKey key = {iface.name(), iface.index(), ttl, loopback};
+
+    std::lock_guard<std::mutex> lock(multicastTxSocketsMutex);
+
+    auto& entry = multicastTxSockets[key];
+    if(entry.descriptor == -1)
+    {
+        entry.descriptor = NativeSocket::openMulticastTxSocket(key.interfaceIndex, iface.ipv4Address(), ttl, loopback, error);
+        if(entry.descriptor == -1)
+        {
+            multicastTxSockets.erase(key);
+            return -1;
+        }
+
+        qCDebug(netudp_tx_pool_log) << "Open multicast tx socket for iface " << key.interfaceName << " (" << key.interfaceIndex
+                                    << "), ttl " << ttl << ", loopback " << loopback;
+    }
+
+    ++entry.borrowers;
+    return entry.descriptor;
+}
+
+void MulticastTxSocketPool::release(const QString& interfaceName, int interfaceIndex, quint8 ttl, bool loopback)
+{
+    std::lock_guard<std::mutex> lock(multicastTxSocketsMutex);
+
+    const auto it = multicastTxSockets.find({interfaceName, interfaceIndex, ttl, loopback});
+    if(it == multicastTxSockets.end())
+    {
+        qCWarning(netudp_tx_pool_log) << "Release multicast tx socket of iface " << interfaceName << " that isn't borrowed";
+        return;
+    }
+
+    Q_ASSERT(it->second.borrowers);
+    if(--it->second.borrowers)
+        return;
+
+    qCDebug(netudp_tx_pool_log) << "Close multicast tx socket for iface " << interfaceName << ", ttl " << ttl << ", loopback "
+                                << loopback;
+    NativeSocket::closeSocket(it->second.descriptor);
+    multicastTxSockets.erase(it);
+}
+
+std::size_t MulticastTxSocketPool::socketCount()
+{
+    std::lock_guard<std::mutex> lock(multicastTxSocketsMutex);
+    return multicastTxSockets.size();
+}
+
+std::size_t MulticastTxSocketPool::borrowerCount()
+{
+    std::lock_guard<std::mutex> lock(multicastTxSocketsMutex);
+    std::size_t borrowers = 0;
+    for(const auto& [key, entry]: multicastTxSockets)
+        borrowers += entry.borrowers;
+    return borrowers;
+}
+
+void MulticastTxSocketPool::addWatcher()
+{
+    if(_watchers.fetch_add(1) == 0)
+        QMetaObject::invokeMethod(this, "updateTimer", Qt::QueuedConnection);
+}
+
+void MulticastTxSocketPool::removeWatcher()
+{
+    if(_watchers.fetch_sub(1) == 1)
+        QMetaObject::invokeMethod(this, "updateTimer", Qt::QueuedConnection);
+}
+
+void MulticastTxSocketPool::updateTimer()
+{
+    if(_watchers.load() > 0)
+    {
+        // Interfaces events are pushed by the monitor, the timer only catch what it could miss
+        const auto* const monitor = InterfacesMonitor::instance();
+        const auto interval = monitor && monitor->isActive() ? 10000 : 2500;
+
+        if(!_timer)
+        {
+            _timer = new QTimer(this);
+            _timer->setSingleShot(false);
+            _timer->setTimerType(Qt::VeryCoarseTimer);
+            connect(_timer, &QTimer::timeout, this, &MulticastTxSocketPool::maintenanceRequested);
+        }
+
+        if(!_timer->isActive() || _timer->interval() != interval)
+            _timer->start(interval);
+    }
+    else if(_timer)
+    {
+        _timer->stop();
+    }
+}
+
+}
+
+#include "moc_MulticastTxSocketPool.cpp"
@@ -0,0 +1,76 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_MULTICAST_TX_SOCKET_POOL_HPP__
+#define __NETUDP_MULTICAST_TX_SOCKET_POOL_HPP__
+
+#include <NetUdp/Export.hpp>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+QT_FORWARD_DECLARE_CLASS(QTimer);
+
+namespace netudp {
+
+class IInterface;
+
+// Multicast tx sockets shared by every worker of the process, one per (interface name and index, ttl, loopback).
+// Sockets are native descriptors only used with NativeSocket::writeDatagram, so workers write to them from their own thread.
+// The instance drive the output watcher of every worker with a single timer.
+class NETUDP_API_ MulticastTxSocketPool : public QObject
+{
+    Q_OBJECT
+
+    // ────── CONSTRUCTOR ────────
+private:
+    MulticastTxSocketPool();
+
+public:
+    ~MulticastTxSocketPool() override;
+
+    // Lives in the QCoreApplication thread. The QCoreApplication and every worker watching its output interfaces share the
+    // instance, the last one to release it destroy it. Return nullptr when there is no QCoreApplication.
+    static std::shared_ptr<MulticastTxSocketPool> instance();
+
+    // ────── SOCKETS ────────
+public:
+    // Borrow the socket of 'iface' with 'ttl' and 'loopback', created by the first borrower.
+    // An iface that is removed and added again get a new os index, and so a new socket.
+    // Return -1 when the socket can't be created, and fill 'error' if not null. Thread safe.
+    static qintptr acquire(const IInterface& iface, quint8 ttl, bool loopback, QString* error = nullptr);
+    // Give back a socket returned by 'acquire'. It is closed with its last borrower. Thread safe.
+    static void release(const QString& interfaceName, int interfaceIndex, quint8 ttl, bool loopback);
+
+    // Sockets currently open, and borrowers of all of them.
+    static std::size_t socketCount();
+    static std::size_t borrowerCount();
+
+    // ────── WATCHER ────────
+public:
+    // 'maintenanceRequested' is emitted periodically while there is at least one watcher. Thread safe.
+    void addWatcher();
+    void removeWatcher();
+
+Q_SIGNALS:
+    // Workers check their output interfaces, and release the sockets of lost ones.
+    void maintenanceRequested();
+
+private Q_SLOTS:
+    void updateTimer();
+
+private:
+    QTimer* _timer = nullptr;
+    std::atomic<int> _watchers = {0};
+};
+
+}
+
+#endif
@@ -0,0 +1,572 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <NetUdp/NativeSocket.hpp>
+#include <QtCore/QByteArray>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QDebug>
+#include <QtNetwork/QHostAddress>
+#include <QtNetwork/QUdpSocket>
+#include <cstring>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#    include <winsock2.h>
+#    include <ws2tcpip.h>
+#else
+#    include <sys/types.h>
+#    include <sys/socket.h>
+#    include <sys/uio.h>
+#    include <netinet/in.h>
+#    include <unistd.h>
+#    include <fcntl.h>
+#    include <climits>
+#    include <cerrno>
+#endif
+#ifdef Q_OS_LINUX
+#    include <linux/netlink.h>
+#    include <linux/rtnetlink.h>
+#    include <sys/time.h>
+#endif
+
+Q_LOGGING_CATEGORY(netudp_native_log, "netudp.native");
+
+namespace netudp {
+
+#ifdef Q_OS_WIN
+using NativeSocketLength = int;
+using NativeSocketHandle = SOCKET;
+#else
+using NativeSocketLength = socklen_t;
+using NativeSocketHandle = int;
+#endif
+
+// Above that count, iovec/WSABUF are allocated on the heap
+static constexpr std::size_t nativeStackBufferCount = 16;
+
+static bool nativeAddressFromHost(const QHostAddress& host, quint16 port, sockaddr_storage& storage, NativeSocketLength& length)
+{
+    std::memset(&storage, 0, sizeof(storage));
+
+    if(host.protocol() == QAbstractSocket::IPv4Protocol)
+    {
+        auto* const address = reinterpret_cast<sockaddr_in*>(&storage);
+        address->sin_family = AF_INET;
+        address->sin_port = htons(port);
+        address->sin_addr.s_addr = htonl(host.toIPv4Address());
+        length = sizeof(sockaddr_in);
+        return true;
+    }
+
+    if(host.protocol() == QAbstractSocket::IPv6Protocol)
+    {
+        auto* const address = reinterpret_cast<sockaddr_in6*>(&storage);
+        const Q_IPV6ADDR ip = host.toIPv6Address();
+        address->sin6_family = AF_INET6;
+        address->sin6_port = htons(port);
+        std::memcpy(&address->sin6_addr, &ip, sizeof(ip));
+        address->sin6_scope_id = host.scopeId().toUInt();
+        length = sizeof(sockaddr_in6);
+        return true;
+    }
+
+    return false;
+}
+
+static std::size_t nativeTotalLength(const ConstBuffer* buffers, std::size_t count)
+{
+    std::size_t totalLength = 0;
+    for(std::size_t i = 0; i < count; ++i)
+        totalLength += buffers[i].length;
+    return totalLength;
+}
+
+static qint64 nativeWriteConcatenated(QUdpSocket* socket, const ConstBuffer* buffers, std::size_t count, const QHostAddress& host, quint16 port)
+{
+    const auto totalLength = nativeTotalLength(buffers, count);
+
+    QByteArray datagram;
+    datagram.reserve(int(totalLength));
+    for(std::size_t i = 0; i < count; ++i)
+        datagram.append(reinterpret_cast<const char*>(buffers[i].data), int(buffers[i].length));
+
+    return socket->writeDatagram(datagram, host, port);
+}
+
+qint64 NativeSocket::writeDatagram(QUdpSocket* socket, const ConstBuffer* buffers, std::size_t count, const QHostAddress& host, quint16 port)
+{
+    Q_CHECK_PTR(socket);
+
+    if(!count)
+        return 0;
+
+    // Nothing to gather, let Qt do the job
+    if(count == 1)
+        return socket->writeDatagram(reinterpret_cast<const char*>(buffers->data), qint64(buffers->length), host, port);
+
+    // socketDescriptor is only valid once Qt initialized the native socket (bind or first write).
+    // The address family of the destination also need to match the one of the socket, Qt handle v4 mapped addresses for us.
+    const auto localProtocol = socket->localAddress().protocol();
+    if(socket->socketDescriptor() == -1 || localProtocol != host.protocol())
+        return nativeWriteConcatenated(socket, buffers, count, host, port);
+
+    return writeDatagram(socket->socketDescriptor(), buffers, count, host, port);
+}
+
+qint64 NativeSocket::writeDatagram(qintptr descriptor, const ConstBuffer* buffers, std::size_t count, const QHostAddress& host, quint16 port)
+{
+    if(descriptor == -1)
+        return -1;
+
+    sockaddr_storage address;
+    NativeSocketLength addressLength = 0;
+    if(!nativeAddressFromHost(host, port, address, addressLength))
+    {
+        qCWarning(netudp_native_log) << "Can't write datagram to unsupported address " << host;
+        return -1;
+    }
+
+#ifdef Q_OS_WIN
+    WSABUF stackBuffers[nativeStackBufferCount];
+    std::vector<WSABUF> heapBuffers;
+    WSABUF* nativeBuffers = stackBuffers;
+    if(count > nativeStackBufferCount)
+    {
+        heapBuffers.resize(count);
+        nativeBuffers = heapBuffers.data();
+    }
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        nativeBuffers[i].buf = reinterpret_cast<CHAR*>(const_cast<std::uint8_t*>(buffers[i].data));
+        nativeBuffers[i].len = ULONG(buffers[i].length);
+    }
+
+    DWORD bytesSent = 0;
+    const auto result = ::WSASendTo(SOCKET(descriptor),
+        nativeBuffers,
+        DWORD(count),
+        &bytesSent,
+        0,
+        reinterpret_cast<const sockaddr*>(&address),
+        addressLength,
+        nullptr,
+        nullptr);
+
+    if(result == SOCKET_ERROR)
+    {
+        const auto error = ::WSAGetLastError();
+        // The send buffer is full, the datagram is dropped as a full interface queue would. The socket is healthy.
+        if(error == WSAEWOULDBLOCK)
+        {
+            qCDebug(netudp_native_log) << "Send buffer is full, drop datagram";
+            return qint64(nativeTotalLength(buffers, count));
+        }
+
+        qCWarning(netudp_native_log) << "WSASendTo failed : " << qt_error_string(error);
+        return -1;
+    }
+
+    return qint64(bytesSent);
+#else
+    if(count > std::size_t(IOV_MAX))
+    {
+        qCWarning(netudp_native_log) << "Can't write a datagram made of " << count << " buffers, limit is " << IOV_MAX;
+        return -1;
+    }
+
+    iovec stackBuffers[nativeStackBufferCount];
+    std::vector<iovec> heapBuffers;
+    iovec* nativeBuffers = stackBuffers;
+    if(count > nativeStackBufferCount)
+    {
+        heapBuffers.resize(count);
+        nativeBuffers = heapBuffers.data();
+    }
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        nativeBuffers[i].iov_base = const_cast<std::uint8_t*>(buffers[i].data);
+        nativeBuffers[i].iov_len = buffers[i].length;
+    }
+
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_name = &address;
+    message.msg_namelen = addressLength;
+    message.msg_iov = nativeBuffers;
+    message.msg_iovlen = decltype(message.msg_iovlen)(count);
+
+    ssize_t bytesSent = 0;
+    do
+    {
+        bytesSent = ::sendmsg(int(descriptor), &message, 0);
+    } while(bytesSent < 0 && errno == EINTR);
+
+    if(bytesSent < 0)
+    {
+        // The send buffer is full, the datagram is dropped as a full interface queue would. The socket is healthy.
+        if(errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            qCDebug(netudp_native_log) << "Send buffer is full, drop datagram";
+            return qint64(nativeTotalLength(buffers, count));
+        }
+
+        qCWarning(netudp_native_log) << "sendmsg failed : " << qt_error_string(errno);
+        return -1;
+    }
+
+    return qint64(bytesSent);
+#endif
+}
+
+#ifdef Q_OS_WIN
+static int nativeLastError()
+{
+    return ::WSAGetLastError();
+}
+#else
+static int nativeLastError()
+{
+    return errno;
+}
+#endif
+
+static bool nativeMulticastMembership(qintptr descriptor, int option, const QHostAddress& group, int interfaceIndex, QString* error)
+{
+    if(descriptor == -1)
+    {
+        if(error)
+            *error = QStringLiteral("Invalid socket descriptor");
+        return false;
+    }
+
+    group_req request;
+    std::memset(&request, 0, sizeof(request));
+    request.gr_interface = decltype(request.gr_interface)(interfaceIndex);
+
+    NativeSocketLength length = 0;
+    if(!nativeAddressFromHost(group, 0, request.gr_group, length))
+    {
+        if(error)
+            *error = QStringLiteral("Unsupported group address ") + group.toString();
+        return false;
+    }
+
+    const int level = group.protocol() == QAbstractSocket::IPv6Protocol ? IPPROTO_IPV6 : IPPROTO_IP;
+    const auto* const value = reinterpret_cast<const char*>(&request);
+    if(::setsockopt(NativeSocketHandle(descriptor), level, option, value, sizeof(request)) != 0)
+    {
+        if(error)
+            *error = qt_error_string(nativeLastError());
+        return false;
+    }
+    return true;
+}
+
+bool NativeSocket::joinMulticastGroup(qintptr descriptor, const QHostAddress& group, int interfaceIndex, QString* error)
+{
+    return nativeMulticastMembership(descriptor, MCAST_JOIN_GROUP, group, interfaceIndex, error);
+}
+
+bool NativeSocket::leaveMulticastGroup(qintptr descriptor, const QHostAddress& group, int interfaceIndex, QString* error)
+{
+    return nativeMulticastMembership(descriptor, MCAST_LEAVE_GROUP, group, interfaceIndex, error);
+}
+
+static bool nativeMulticastSourceMembership(
+    qintptr descriptor, int option, const QHostAddress& group, const QHostAddress& source, int interfaceIndex, QString* error)
+{
+    if(descriptor == -1)
+    {
+        if(error)
+            *error = QStringLiteral("Invalid socket descriptor");
+        return false;
+    }
+
+    if(group.protocol() != source.protocol())
+    {
+        if(error)
+            *error = QStringLiteral("Source ") + source.toString() + QStringLiteral(" and group ") + group.toString()
+                     + QStringLiteral(" protocols differ");
+        return false;
+    }
+
+    group_source_req request;
+    std::memset(&request, 0, sizeof(request));
+    request.gsr_interface = decltype(request.gsr_interface)(interfaceIndex);
+
+    NativeSocketLength length = 0;
+    if(!nativeAddressFromHost(group, 0, request.gsr_group, length) || !nativeAddressFromHost(source, 0, request.gsr_source, length))
+    {
+        if(error)
+            *error = QStringLiteral("Unsupported group address ") + group.toString();
+        return false;
+    }
+
+    const int level = group.protocol() == QAbstractSocket::IPv6Protocol ? IPPROTO_IPV6 : IPPROTO_IP;
+    const auto* const value = reinterpret_cast<const char*>(&request);
+    if(::setsockopt(NativeSocketHandle(descriptor), level, option, value, sizeof(request)) != 0)
+    {
+        if(error)
+            *error = qt_error_string(nativeLastError());
+        return false;
+    }
+    return true;
+}
+
+bool NativeSocket::joinMulticastSource(
+    qintptr descriptor, const QHostAddress& group, const QHostAddress& source, int interfaceIndex, QString* error)
+{
+    return nativeMulticastSourceMembership(descriptor, MCAST_JOIN_SOURCE_GROUP, group, source, interfaceIndex, error);
+}
+
+bool NativeSocket::leaveMulticastSource(
+    qintptr descriptor, const QHostAddress& group, const QHostAddress& source, int interfaceIndex, QString* error)
+{
+    return nativeMulticastSourceMembership(descriptor, MCAST_LEAVE_SOURCE_GROUP, group, source, interfaceIndex, error);
+}
+
+bool NativeSocket::blockMulticastSource(
+    qintptr descriptor, const QHostAddress& group, const QHostAddress& source, int interfaceIndex, QString* error)
+{
+    return nativeMulticastSourceMembership(descriptor, MCAST_BLOCK_SOURCE, group, source, interfaceIndex, error);
+}
+
+bool NativeSocket::unblockMulticastSource(
+    qintptr descriptor, const QHostAddress& group, const QHostAddress& source, int interfaceIndex, QString* error)
+{
+    return nativeMulticastSourceMembership(descriptor, MCAST_UNBLOCK_SOURCE, group, source, interfaceIndex, error);
+}
+
+template<typename T>
+static bool nativeSetOption(qintptr descriptor, int level, int option, T value, const QString& name, QString* error)
+{
+    if(::setsockopt(NativeSocketHandle(descriptor), level, option, reinterpret_cast<const char*>(&value), sizeof(value)) == 0)
+        return true;
+
+    if(error)
+        *error = QStringLiteral("Fail to set ") + name + QStringLiteral(" : ") + qt_error_string(nativeLastError());
+    return false;
+}
+
+qintptr NativeSocket::openMulticastTxSocket(
+    int interfaceIndex, const QHostAddress& interfaceAddress, quint8 ttl, bool loopback, QString* error)
+{
+    // Workers write from their own thread: a full send buffer must not block them. Child processes don't inherit the socket.
+#ifdef Q_OS_LINUX
+    const auto descriptor = qintptr(::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP));
+#else
+    const auto descriptor = qintptr(::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+#endif
+#ifdef Q_OS_WIN
+    if(NativeSocketHandle(descriptor) == INVALID_SOCKET)
+#else
+    if(descriptor < 0)
+#endif
+    {
+        if(error)
+            *error = qt_error_string(nativeLastError());
+        return -1;
+    }
+
+#if defined(Q_OS_WIN)
+    u_long nonBlocking = 1;
+    const bool configured = ::ioctlsocket(SOCKET(descriptor), FIONBIO, &nonBlocking) == 0;
+#elif defined(Q_OS_LINUX)
+    const bool configured = true;
+#else
+    const int flags = ::fcntl(int(descriptor), F_GETFL);
+    const bool configured = flags != -1 && ::fcntl(int(descriptor), F_SETFL, flags | O_NONBLOCK) != -1
+                            && ::fcntl(int(descriptor), F_SETFD, FD_CLOEXEC) != -1;
+#endif
+    if(!configured)
+    {
+        if(error)
+            *error = qt_error_string(nativeLastError());
+        closeSocket(descriptor);
+        return -1;
+    }
+
+    // Option types differ: DWORD on Windows, int on Linux, u_char for ttl and loop on BSD
+#if defined(Q_OS_WIN)
+    using NativeMulticastOption = DWORD;
+#elif defined(Q_OS_LINUX)
+    using NativeMulticastOption = int;
+#else
+    using NativeMulticastOption = u_char;
+#endif
+
+#if defined(Q_OS_LINUX)
+    ip_mreqn iface;
+    std::memset(&iface, 0, sizeof(iface));
+    iface.imr_ifindex = interfaceIndex;
+    Q_UNUSED(interfaceAddress);
+#elif defined(Q_OS_WIN)
+    // An address of the form 0.0.0.x is an interface index
+    const DWORD iface = htonl(DWORD(interfaceIndex));
+    Q_UNUSED(interfaceAddress);
+#else
+    Q_UNUSED(interfaceIndex);
+    in_addr iface;
+    iface.s_addr = htonl(interfaceAddress.toIPv4Address());
+#endif
+
+    const NativeMulticastOption ttlValue = ttl;
+    const NativeMulticastOption loopValue = loopback ? 1 : 0;
+    const auto success = nativeSetOption(descriptor, IPPROTO_IP, IP_MULTICAST_IF, iface, QStringLiteral("IP_MULTICAST_IF"), error)
+                         && nativeSetOption(descriptor, IPPROTO_IP, IP_MULTICAST_TTL, ttlValue, QStringLiteral("IP_MULTICAST_TTL"), error)
+                         && nativeSetOption(descriptor,
+                             IPPROTO_IP,
+                             IP_MULTICAST_LOOP,
+                             loopValue,
+                             QStringLiteral("IP_MULTICAST_LOOP"),
+                             error);
+
+    if(!success)
+    {
+        closeSocket(descriptor);
+        return -1;
+    }
+
+    return descriptor;
+}
+
+void NativeSocket::closeSocket(qintptr descriptor)
+{
+    if(descriptor == -1)
+        return;
+
+#ifdef Q_OS_WIN
+    ::closesocket(SOCKET(descriptor));
+#else
+    ::close(int(descriptor));
+#endif
+}
+
+bool NativeSocket::setMulticastAll(qintptr descriptor, bool enabled)
+{
+#if defined(Q_OS_LINUX) && defined(IP_MULTICAST_ALL)
+    const int value = enabled ? 1 : 0;
+    if(descriptor == -1 || ::setsockopt(int(descriptor), IPPROTO_IP, IP_MULTICAST_ALL, &value, sizeof(value)) != 0)
+    {
+        qCWarning(netudp_native_log) << "Fail to set IP_MULTICAST_ALL to " << enabled << " : " << qt_error_string(errno);
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(descriptor);
+    Q_UNUSED(enabled);
+    return false;
+#endif
+}
+
+int NativeSocket::routeInterfaceIndex(const QHostAddress& destination, QString* error)
+{
+#ifdef Q_OS_LINUX
+    const bool isIpv4 = destination.protocol() == QAbstractSocket::IPv4Protocol;
+    if(!isIpv4 && destination.protocol() != QAbstractSocket::IPv6Protocol)
+    {
+        if(error)
+            *error = QStringLiteral("Unsupported address protocol");
+        return 0;
+    }
+
+    struct
+    {
+        nlmsghdr header;
+        rtmsg message;
+        char attributes[RTA_SPACE(sizeof(Q_IPV6ADDR))];
+    } request;
+    std::memset(&request, 0, sizeof(request));
+
+    const quint32 ipv4 = htonl(destination.toIPv4Address());
+    const Q_IPV6ADDR ipv6 = destination.toIPv6Address();
+    const std::size_t addressLength = isIpv4 ? sizeof(ipv4) : sizeof(ipv6);
+
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(rtmsg));
+    request.header.nlmsg_type = RTM_GETROUTE;
+    request.header.nlmsg_flags = NLM_F_REQUEST;
+    request.header.nlmsg_seq = 1;
+    request.message.rtm_family = isIpv4 ? AF_INET : AF_INET6;
+    request.message.rtm_dst_len = quint8(addressLength * 8);
+
+    auto* const attribute = reinterpret_cast<rtattr*>(reinterpret_cast<char*>(&request) + NLMSG_ALIGN(request.header.nlmsg_len));
+    attribute->rta_type = RTA_DST;
+    attribute->rta_len = RTA_LENGTH(addressLength);
+    std::memcpy(RTA_DATA(attribute), isIpv4 ? static_cast<const void*>(&ipv4) : static_cast<const void*>(&ipv6), addressLength);
+    request.header.nlmsg_len = NLMSG_ALIGN(request.header.nlmsg_len) + RTA_LENGTH(addressLength);
+
+    const int descriptor = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if(descriptor < 0)
+    {
+        if(error)
+            *error = qt_error_string(errno);
+        return 0;
+    }
+
+    // The kernel answer synchronously, the timeout only guard the worker against a lost reply
+    timeval timeout = {};
+    timeout.tv_usec = 100000;
+    ::setsockopt(descriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_nl kernel = {};
+    kernel.nl_family = AF_NETLINK;
+
+    int interfaceIndex = 0;
+    QString failure;
+    if(::sendto(descriptor, &request, request.header.nlmsg_len, 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)) < 0)
+    {
+        failure = qt_error_string(errno);
+    }
+    else
+    {
+        alignas(nlmsghdr) char reply[4096];
+        auto length = ::recv(descriptor, reply, sizeof(reply), 0);
+        if(length < 0)
+            failure = qt_error_string(errno);
+
+        for(auto* header = reinterpret_cast<nlmsghdr*>(reply); length > 0 && NLMSG_OK(header, quint32(length));
+            header = NLMSG_NEXT(header, length))
+        {
+            if(header->nlmsg_type == NLMSG_ERROR)
+            {
+                const auto* const nlError = static_cast<const nlmsgerr*>(NLMSG_DATA(header));
+                if(nlError->error)
+                    failure = qt_error_string(-nlError->error);
+                break;
+            }
+
+            if(header->nlmsg_type != RTM_NEWROUTE)
+                continue;
+
+            auto* const route = static_cast<rtmsg*>(NLMSG_DATA(header));
+            int attributesLength = int(RTM_PAYLOAD(header));
+            for(auto* it = RTM_RTA(route); RTA_OK(it, attributesLength); it = RTA_NEXT(it, attributesLength))
+            {
+                if(it->rta_type == RTA_OIF)
+                    std::memcpy(&interfaceIndex, RTA_DATA(it), sizeof(interfaceIndex));
+            }
+            break;
+        }
+    }
+
+    ::close(descriptor);
+
+    if(!failure.isEmpty() && error)
+        *error = failure;
+    return interfaceIndex;
+#else
+    Q_UNUSED(destination);
+    if(error)
+        *error = QStringLiteral("Route table lookup isn't supported on this platform");
+    return 0;
+#endif
+}
+
+}
@@ -0,0 +1,75 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_NATIVE_SOCKET_HPP__
+#define __NETUDP_NATIVE_SOCKET_HPP__
+
+#include <NetUdp/Export.hpp>
+#include <NetUdp/ConstBuffer.hpp>
+#include <QtCore/QtGlobal>
+#include <QtCore/QString>
+
+QT_FORWARD_DECLARE_CLASS(QHostAddress);
+QT_FORWARD_DECLARE_CLASS(QUdpSocket);
+
+namespace netudp {
+
+// Operations that QUdpSocket doesn't expose, done directly on the socket descriptor.
+class NETUDP_API_ NativeSocket
+{
+public:
+    // Write 'count' buffers as a single datagram to 'host:port'.
+    // Use scatter/gather io (sendmsg/WSASendTo) when the socket descriptor is available,
+    // otherwise fallback to a concatenation in a QByteArray.
+    // Return the number of bytes written, or -1 on error.
+    // When the send buffer of a non blocking socket is full, the datagram is dropped and reported as written.
+    static qint64 writeDatagram(
+        QUdpSocket* socket, const ConstBuffer* buffers, std::size_t count, const QHostAddress& host, quint16 port);
+
+    // Same as above, but directly on a socket descriptor. Return -1 if the descriptor is invalid.
+    static qint64 writeDatagram(
+        qintptr descriptor, const ConstBuffer* buffers, std::size_t count, const QHostAddress& host, quint16 port);
+
+    // Join/leave 'group' on the interface with os index 'interfaceIndex' (MCAST_JOIN_GROUP/MCAST_LEAVE_GROUP).
+    // Unlike QUdpSocket, doesn't need a QNetworkInterface, that cost an enumeration of every interface to build.
+    // On failure, return false and fill 'error' if not null.
+    static bool joinMulticastGroup(qintptr descriptor, const QHostAddress& group, int interfaceIndex, QString* error = nullptr);
+    static bool leaveMulticastGroup(qintptr descriptor, const QHostAddress& group, int interfaceIndex, QString* error = nullptr);
+
+    // Source specific membership (MCAST_JOIN_SOURCE_GROUP/MCAST_LEAVE_SOURCE_GROUP): only datagrams sent by 'source' to 'group'
+    // are received. Call once per source.
+    static bool joinMulticastSource(
+        qintptr descriptor, const QHostAddress& group, const QHostAddress& source, int interfaceIndex, QString* error = nullptr);
+    static bool leaveMulticastSource(
+        qintptr descriptor, const QHostAddress& group, const QHostAddress& source, int interfaceIndex, QString* error = nullptr);
+    // Filter out 'source' from an any source membership (MCAST_BLOCK_SOURCE/MCAST_UNBLOCK_SOURCE). Leaving the group drop the filter.
+    static bool blockMulticastSource(
+        qintptr descriptor, const QHostAddress& group, const QHostAddress& source, int interfaceIndex, QString* error = nullptr);
+    static bool unblockMulticastSource(
+        qintptr descriptor, const QHostAddress& group, const QHostAddress& source, int interfaceIndex, QString* error = nullptr);
+
+    // Linux only (IP_MULTICAST_ALL), return false elsewhere.
+    // When disabled, a socket bound to a wildcard address only receive the groups it joined itself,
+    // instead of every group joined on its port by any socket of the host.
+    static bool setMulticastAll(qintptr descriptor, bool enabled);
+
+    // Open a non blocking, close on exec, IPv4 udp socket that send multicast on 'interfaceIndex', with 'ttl' and 'loopback' already set.
+    // 'interfaceAddress' is only used where the interface can't be selected by index (macOS/BSD).
+    // The socket isn't bound, the os pick a port at first write. Return -1 on failure.
+    static qintptr openMulticastTxSocket(
+        int interfaceIndex, const QHostAddress& interfaceAddress, quint8 ttl, bool loopback, QString* error = nullptr);
+    static void closeSocket(qintptr descriptor);
+
+    // Os index of the interface the kernel route 'destination' through, asked with a netlink RTM_GETROUTE request.
+    // Linux only. Return 0 if there is no route, or on failure and fill 'error' if not null.
+    static int routeInterfaceIndex(const QHostAddress& destination, QString* error = nullptr);
+};
+
+}
+
+#endif
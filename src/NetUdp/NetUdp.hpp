@@ -12,6 +12,17 @@
 #include <NetUdp/Version.hpp>
 #include <NetUdp/Utils.hpp>
 #include <NetUdp/RecycledDatagram.hpp>
+#include <NetUdp/InlineDatagram.hpp>
+#include <NetUdp/DatagramPool.hpp>
+#include <NetUdp/RxMemoryBudget.hpp>
+#include <NetUdp/MulticastTxSocketPool.hpp>
+#include <NetUdp/MulticastEgressPolicy.hpp>
+#include <NetUdp/WatchdogComponent.hpp>
+#include <NetUdp/FixedDatagram.hpp>
+#include <NetUdp/ByteArrayDatagram.hpp>
+#include <NetUdp/DatagramSlice.hpp>
+#include <NetUdp/ConstBuffer.hpp>
 #include <NetUdp/Socket.hpp>
+#include <NetUdp/FixedDatagramSocket.hpp>
 
 #endif
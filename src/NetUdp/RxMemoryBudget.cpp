@@ -0,0 +1,57 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <NetUdp/RxMemoryBudget.hpp>
+
+namespace netudp {
+
+RxMemoryBudget& RxMemoryBudget::instance()
+{
+    static RxMemoryBudget budget;
+    return budget;
+}
+
+quint64 RxMemoryBudget::capacity() const
+{
+    return _capacity.load(std::memory_order_relaxed);
+}
+
+void RxMemoryBudget::setCapacity(quint64 bytes)
+{
+    _capacity.store(bytes, std::memory_order_relaxed);
+}
+
+quint64 RxMemoryBudget::used() const
+{
+    return _used.load(std::memory_order_relaxed);
+}
+
+bool RxMemoryBudget::tryAcquire(quint64 bytes, qreal weight)
+{
+    const auto capacity = this->capacity();
+    if(!capacity)
+        return true;
+
+    const auto limit = quint64(qreal(capacity) * qBound(qreal(0), weight, qreal(1)));
+    auto used = _used.load(std::memory_order_relaxed);
+    do
+    {
+        if(used + bytes > limit)
+            return false;
+    } while(!_used.compare_exchange_weak(used, used + bytes, std::memory_order_relaxed));
+
+    return true;
+}
+
+void RxMemoryBudget::release(quint64 bytes)
+{
+    Q_ASSERT(used() >= bytes);
+    _used.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,57 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_RX_MEMORY_BUDGET_HPP__
+#define __NETUDP_RX_MEMORY_BUDGET_HPP__
+
+#include <NetUdp/Export.hpp>
+#include <QtCore/QtGlobal>
+#include <atomic>
+
+namespace netudp {
+
+// Process wide cap on the memory held by received datagrams, shared by every Worker.
+// A datagram is charged when the worker receive it, and released when its last reference is dropped,
+// so it account for datagrams waiting in the rx queue as well as the one kept by the application.
+// Each socket admit a datagram only if the total stay below 'capacity * weight':
+// when the budget is tight, sockets with a low weight start to drop first, and the one with a weight of 1 drop last.
+// Datagrams are charged by Datagram::capacity(). Datagrams recycled by a pool stay charged until they are reused,
+// so the memory cached by FixedDatagramPool count as well.
+class NETUDP_API_ RxMemoryBudget
+{
+    // ────── CONSTRUCTOR ────────
+public:
+    RxMemoryBudget() = default;
+    RxMemoryBudget(const RxMemoryBudget&) = delete;
+    RxMemoryBudget& operator=(const RxMemoryBudget&) = delete;
+
+    // Budget shared by every socket of the process
+    static RxMemoryBudget& instance();
+
+    // ────── API ────────
+public:
+    // Cap in bytes. 0 (default) disable the budget, and nothing is accounted.
+    quint64 capacity() const;
+    void setCapacity(quint64 bytes);
+
+    // Bytes currently charged
+    quint64 used() const;
+
+    // Charge 'bytes' if the usage stay below 'capacity * weight'. 'weight' is clamped in [0, 1].
+    // Always succeed when the budget is disabled.
+    bool tryAcquire(quint64 bytes, qreal weight);
+    void release(quint64 bytes);
+
+private:
+    std::atomic<quint64> _capacity = {0};
+    std::atomic<quint64> _used = {0};
+};
+
+}
+
+#endif
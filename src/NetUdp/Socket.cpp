@@ -8,34 +8,115 @@
 
 #include <NetUdp/Socket.hpp>
 #include <NetUdp/Worker.hpp>
-#include <NetUdp/RecycledDatagram.hpp>
+#include <NetUdp/DatagramPool.hpp>
+#include <NetUdp/ByteArrayDatagram.hpp>
 #include <QtCore/QThread>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QDebug>
 #include <QtNetwork/QHostAddress>
-#include <Recycler/Circular.hpp>
+#include <algorithm>
+#include <iterator>
 #include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
 
 Q_LOGGING_CATEGORY(netudp_socket_log, "netudp.socket");
 
 namespace netudp {
 
+// Worker threads quit without waiting for them. They delete themselves once finished, those still running when the
+// QCoreApplication is destroyed are joined there, rather than running during static destruction.
+static std::mutex socketDetachedThreadsMutex;
+static std::set<QThread*> socketDetachedThreads;
+static bool socketDetachedThreadsRoutineAdded = false;
+
+static void socketJoinDetachedThreads()
+{
+    std::set<QThread*> threads;
+    {
+        const std::lock_guard<std::mutex> lock(socketDetachedThreadsMutex);
+        threads.swap(socketDetachedThreads);
+        socketDetachedThreadsRoutineAdded = false;
+    }
+
+    for(auto* const thread: threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+}
+
+static void socketDetachWorkerThread(QThread* thread)
+{
+    thread->setParent(nullptr);
+
+    {
+        const std::lock_guard<std::mutex> lock(socketDetachedThreadsMutex);
+        socketDetachedThreads.insert(thread);
+        if(!socketDetachedThreadsRoutineAdded)
+        {
+            socketDetachedThreadsRoutineAdded = true;
+            qAddPostRoutine(socketJoinDetachedThreads);
+        }
+    }
+
+    QObject::connect(thread,
+        &QThread::finished,
+        thread,
+        [thread]()
+        {
+            {
+                const std::lock_guard<std::mutex> lock(socketDetachedThreadsMutex);
+                socketDetachedThreads.erase(thread);
+            }
+            thread->deleteLater();
+        });
+}
+
 struct SocketPrivate
 {
     Worker* worker = nullptr;
     QThread* workerThread = nullptr;
+    // True between 'startWorker' and 'stopWorker'. A persistent worker stay alive once stopped.
+    bool workerStarted = false;
+    // Calls to 'stop' not yet followed by 'stopped'
+    int pendingWorkerStops = 0;
+    // Stops of the persistent worker not yet reported by 'Worker::stopped'. Its datagrams are discarded meanwhile.
+    int persistentWorkerStops = 0;
 
     // Recycle datagram to reduce dynamic allocation
-    recycler::Circular<RecycledDatagram> cache;
+    DatagramPool cache;
+
+    // Time since 'cache' was last adapted, the worker statistics period isn't known by the socket
+    QElapsedTimer cacheAdaptTimer;
 
     // Multicast group to which the socket subscribe
     std::set<QString> multicastListeningGroups;
 
+    // Sources of groups joined with a source specific membership, and sources blocked on groups joined for any source.
+    // A group is never in both.
+    std::map<QString, std::set<QString>> multicastIncludedSources;
+    std::map<QString, std::set<QString>> multicastExcludedSources;
+
     // Network Interfaces on which multicast groups are listened.
     std::set<QString> multicastListeningInterfaces;
 
     // Network INterfaces on which multicast datagram are send
     std::set<QString> multicastOutgoingInterfaces;
+
+    // Nesting of beginReconfiguration/endReconfiguration, forwarded to the worker
+    int reconfigurationDepth = 0;
+
+    // Restarts done by the watchdog of the worker, by component
+    std::map<WatchdogComponent, quint64> watchdogRestarts;
+
+    // Interfaces used to send to a group instead of the multicastEgressPolicy ones
+    std::map<QString, std::set<QString>> multicastEgressInterfaces;
 };
 
 ISocket::ISocket(QObject* parent)
@@ -43,10 +124,96 @@ ISocket::ISocket(QObject* parent)
 {
 }
 
+void ISocket::beginReconfiguration()
+{
+}
+
+void ISocket::endReconfiguration()
+{
+}
+
+bool ISocket::joinMulticastGroup(const QString&, const QString&)
+{
+    return false;
+}
+
+bool ISocket::leaveMulticastGroup(const QString&, const QString&)
+{
+    return false;
+}
+
+QStringList ISocket::multicastSources(const QString&) const
+{
+    return {};
+}
+
+bool ISocket::blockMulticastSource(const QString&, const QString&)
+{
+    return false;
+}
+
+bool ISocket::unblockMulticastSource(const QString&, const QString&)
+{
+    return false;
+}
+
+QStringList ISocket::blockedMulticastSources(const QString&) const
+{
+    return {};
+}
+
+bool ISocket::setMulticastEgressInterfaces(const QString&, const QStringList&)
+{
+    return false;
+}
+
+QStringList ISocket::multicastEgressInterfaces(const QString&) const
+{
+    return {};
+}
+
+void ISocket::clearWatchdogCounter()
+{
+    resetWatchdogRestartsTotal();
+    resetLastWatchdogRestartReason();
+}
+
+quint64 ISocket::watchdogRestarts(netudp::WatchdogComponent) const
+{
+    return 0;
+}
+
+bool ISocket::sendDatagram(const QByteArray& data, const QString& address, const uint16_t port, const uint8_t ttl)
+{
+    return sendDatagram(data.constData(), size_t(data.size()), address, port, ttl);
+}
+
+bool ISocket::sendDatagramV(ConstBufferList buffers, const QString& address, const uint16_t port, const uint8_t ttl)
+{
+    std::size_t length = 0;
+    for(const auto& buffer: buffers)
+        length += buffer.length;
+
+    std::vector<uint8_t> data;
+    data.reserve(length);
+    for(const auto& buffer: buffers)
+        data.insert(data.end(), buffer.data, buffer.data + buffer.length);
+
+    return sendDatagram(data.data(), data.size(), address, port, ttl);
+}
+
 Socket::Socket(QObject* parent)
     : ISocket(parent)
     , _p(std::make_unique<SocketPrivate>())
 {
+    connect(this,
+        &ISocket::persistentWorkerChanged,
+        this,
+        [this](bool persistent)
+        {
+            if(!persistent && !isRunning())
+                killWorker();
+        });
 }
 
 Socket::~Socket()
@@ -59,31 +226,47 @@ void Socket::killWorker()
     if(!_p->worker)
         return;
 
-    qCDebug(netudp_socket_log) << "Stop Worker " << static_cast<void*>(_p->worker);
-    Q_EMIT stopWorker();
-
     qCDebug(netudp_socket_log) << "Disconnect Worker " << static_cast<void*>(_p->worker);
-    Q_ASSERT(_p->worker);
     disconnect(_p->worker, nullptr, this, nullptr);
     disconnect(this, nullptr, _p->worker, nullptr);
 
-    if(_p->workerThread)
+    auto* const worker = std::exchange(_p->worker, nullptr);
+    auto* const workerThread = std::exchange(_p->workerThread, nullptr);
+    // A persistent worker is already stopped if the socket was
+    const auto workerStarted = std::exchange(_p->workerStarted, false);
+
+    // Stops the persistent worker didn't report yet are reported at once when the worker is gone
+    const auto persistentWorkerStops = std::exchange(_p->persistentWorkerStops, 0);
+    const auto notifyStopped = workerStarted || persistentWorkerStops > 0;
+    _p->pendingWorkerStops -= persistentWorkerStops;
+    if(!workerStarted && persistentWorkerStops > 0)
+        ++_p->pendingWorkerStops;
+
+    if(workerThread)
     {
-        // Ask to delete later in the event loop
-        qCDebug(netudp_socket_log) << "Kill worker thread ...";
-        _p->workerThread->quit();
-        _p->workerThread->wait();
-        _p->workerThread->deleteLater();
-        _p->workerThread = nullptr;
-        // Worker will be deleted with the finished signal from QThread
-        _p->worker = nullptr;
-        qCDebug(netudp_socket_log) << "... Done";
+        // Don't wait for the thread, the worker stop in its thread, then the thread quit and the worker is deleted with 'finished'
+        qCDebug(netudp_socket_log) << "Quit worker thread " << static_cast<void*>(workerThread);
+        socketDetachWorkerThread(workerThread);
+        QMetaObject::invokeMethod(
+            worker,
+            [worker, workerStarted]()
+            {
+                if(workerStarted)
+                    worker->onStop();
+                worker->thread()->quit();
+            },
+            Qt::QueuedConnection);
+        if(notifyStopped)
+            connect(workerThread, &QThread::finished, this, &Socket::onWorkerStopped);
     }
-    else if(_p->worker)
+    else
     {
-        qCDebug(netudp_socket_log) << "Delete worker later" << static_cast<void*>(_p->worker);
-        _p->worker->deleteLater();
-        _p->worker = nullptr;
+        qCDebug(netudp_socket_log) << "Delete worker later" << static_cast<void*>(worker);
+        if(workerStarted)
+            worker->onStop();
+        worker->deleteLater();
+        if(notifyStopped)
+            QMetaObject::invokeMethod(this, "onWorkerStopped", Qt::QueuedConnection);
     }
 }
 
@@ -100,8 +283,13 @@ bool Socket::setUseWorkerThread(const bool& enabled)
             qCDebug(netudp_socket_log) << "Use worker thread change to " << enabled;
         }
 
-        if(isRunning())
-            restart();
+        // The worker is moved to its thread when spawned
+        const auto running = isRunning();
+        if(running)
+            stop();
+        killWorker();
+        if(running)
+            start();
         return true;
     }
     return false;
@@ -114,11 +302,39 @@ QStringList Socket::multicastGroups() const
 
 bool Socket::setMulticastGroups(const QStringList& value)
 {
-    leaveAllMulticastGroups();
+    std::set<QString> groups;
     for(const auto& group: value)
     {
-        joinMulticastGroup(group);
+        if(QHostAddress(group).isMulticast())
+            groups.insert(group);
     }
+
+    // Only send the difference to the worker, groups in both sets keep their memberships
+    QStringList joined;
+    QStringList left;
+    std::set_difference(groups.begin(),
+        groups.end(),
+        _p->multicastListeningGroups.begin(),
+        _p->multicastListeningGroups.end(),
+        std::back_inserter(joined));
+    std::set_difference(_p->multicastListeningGroups.begin(),
+        _p->multicastListeningGroups.end(),
+        groups.begin(),
+        groups.end(),
+        std::back_inserter(left));
+
+    if(joined.isEmpty() && left.isEmpty())
+        return true;
+
+    _p->multicastListeningGroups = std::move(groups);
+    for(const auto& group: left)
+    {
+        _p->multicastIncludedSources.erase(group);
+        _p->multicastExcludedSources.erase(group);
+    }
+    Q_EMIT multicastGroupsChanged(multicastGroups());
+
+    Q_EMIT updateMulticastGroupsWorker(joined, left);
     return true;
 }
 
@@ -169,6 +385,107 @@ bool Socket::start()
 
     setRunning(true);
 
+    if(!_p->worker)
+        spawnWorker();
+
+    // Everything is captured by value, the worker might be configured from its own thread
+    const auto hugePages = cacheHugePages();
+    const auto prewarmCount = std::size_t(prewarmCacheCount());
+    if(prewarmCount)
+    {
+        _p->cache.setHugePages(hugePages);
+        _p->cache.prewarm(prewarmCount);
+    }
+
+    DatagramPoolAdaptivePolicy adaptivePolicy;
+    adaptivePolicy.enabled = adaptiveCache();
+    adaptivePolicy.idleTimeout = adaptiveCacheIdleTimeout();
+    _p->cache.setAdaptivePolicy(adaptivePolicy);
+    _p->cacheAdaptTimer.start();
+
+    const auto configureWorker = [worker = _p->worker,
+                                     hugePages,
+                                     prewarmCount,
+                                     adaptivePolicy,
+                                     rxBudgetWeight = rxBudgetWeight(),
+                                     membershipsPerSocket = multicastMembershipsPerSocket(),
+                                     strictFiltering = multicastStrictFiltering(),
+                                     groupSockets = multicastGroupSockets(),
+                                     includedSources = _p->multicastIncludedSources,
+                                     excludedSources = _p->multicastExcludedSources,
+                                     egressPolicy = multicastEgressPolicy(),
+                                     egressInterfaces = _p->multicastEgressInterfaces,
+                                     watchdog = watchdogPeriod(),
+                                     address = rxAddress(),
+                                     rxPort = rxPort(),
+                                     txPort = txPort(),
+                                     separateSockets = separateRxTxSockets(),
+                                     groups = _p->multicastListeningGroups,
+                                     listeningInterfaces = _p->multicastListeningInterfaces,
+                                     outgoingInterfaces = _p->multicastOutgoingInterfaces,
+                                     input = inputEnabled(),
+                                     loopback = multicastLoopback()]()
+    {
+        worker->setCacheHugePages(hugePages);
+        worker->setCachePrewarmCount(prewarmCount);
+        worker->setCacheAdaptivePolicy(adaptivePolicy);
+
+        worker->setRxBudgetWeight(rxBudgetWeight);
+        worker->setMaxMembershipsPerSocket(membershipsPerSocket);
+        worker->setMulticastStrictFiltering(strictFiltering);
+        worker->setMulticastGroupSockets(groupSockets);
+        for(const auto& [group, sources]: includedSources)
+            worker->setMulticastSourceFilter(group, false, QList<QString>(sources.begin(), sources.end()));
+        for(const auto& [group, sources]: excludedSources)
+            worker->setMulticastSourceFilter(group, true, QList<QString>(sources.begin(), sources.end()));
+        worker->setMulticastEgressPolicy(egressPolicy);
+        for(const auto& [group, interfaces]: egressInterfaces)
+            worker->setMulticastEgressInterfaces(group, QList<QString>(interfaces.begin(), interfaces.end()));
+
+        worker->initialize(watchdog,
+            address,
+            rxPort,
+            txPort,
+            separateSockets,
+            groups,
+            listeningInterfaces,
+            outgoingInterfaces,
+            input,
+            loopback);
+    };
+
+    // Queued before 'startWorker', so applied first
+    if(_p->workerThread)
+        QMetaObject::invokeMethod(_p->worker, configureWorker, Qt::QueuedConnection);
+    else
+        configureWorker();
+
+    connect(_p->worker, &Worker::datagramReceived, this, &Socket::onWorkerDatagramReceived, Qt::QueuedConnection);
+
+    connect(_p->worker, &Worker::isBoundedChanged, this, &Socket::setBounded);
+    connect(_p->worker, &Worker::socketError, this, &Socket::socketError);
+
+    connect(_p->worker, &Worker::rxBytesCounterChanged, this, &Socket::onWorkerRxPerSecondsChanged);
+    connect(_p->worker, &Worker::txBytesCounterChanged, this, &Socket::onWorkerTxPerSecondsChanged);
+    connect(_p->worker, &Worker::rxPacketsCounterChanged, this, &Socket::onWorkerPacketsRxPerSecondsChanged);
+    connect(_p->worker, &Worker::txPacketsCounterChanged, this, &Socket::onWorkerPacketsTxPerSecondsChanged);
+    connect(_p->worker, &Worker::rxBudgetDroppedCounterChanged, this, &Socket::onWorkerRxBudgetDroppedCounterChanged);
+    connect(_p->worker, &Worker::txMulticastCounterChanged, this, &Socket::onWorkerTxMulticastCounterChanged);
+    connect(_p->worker, &Worker::componentRestarted, this, &Socket::onWorkerComponentRestarted);
+    connect(_p->worker, &Worker::cacheStatisticsChanged, this, &Socket::onWorkerCacheStatisticsChanged);
+
+    connect(_p->worker, &Worker::multicastGroupJoined, this, &Socket::multicastGroupJoined);
+    connect(_p->worker, &Worker::multicastGroupLeaved, this, &Socket::multicastGroupLeaved);
+
+    qCDebug(netudp_socket_log) << "Start worker " << _p->worker;
+    _p->workerStarted = true;
+    Q_EMIT startWorker();
+
+    return true;
+}
+
+void Socket::spawnWorker()
+{
     Q_ASSERT(_p->worker == nullptr);
     Q_ASSERT(_p->workerThread == nullptr);
 
@@ -193,23 +510,23 @@ bool Socket::start()
 
     _p->worker->setObjectName("Udp Worker");
 
-    _p->worker->initialize(watchdogPeriod(),
-        rxAddress(),
-        rxPort(),
-        txPort(),
-        separateRxTxSockets(),
-        _p->multicastListeningGroups,
-        _p->multicastListeningInterfaces,
-        _p->multicastOutgoingInterfaces,
-        inputEnabled(),
-        multicastLoopback());
+    // Spawned inside a batch, the worker wait for the same 'endReconfiguration'
+    for(int i = 0; i < _p->reconfigurationDepth; ++i)
+        _p->worker->beginReconfiguration();
 
+    // Connections to the worker live as long as it does, so a stopped worker keep following the socket attributes
     connect(this, &Socket::startWorker, _p->worker, &Worker::onStart);
-    connect(this, &Socket::stopWorker, _p->worker, &Worker::onStop);
+    connect(this, &Socket::stopWorker, _p->worker, &Worker::onStopRequested);
+    connect(_p->worker, &Worker::stopped, this, &Socket::onWorkerStopped, Qt::QueuedConnection);
     connect(this, &Socket::restartWorker, _p->worker, &Worker::onRestart);
+    connect(this, &Socket::beginReconfigurationWorker, _p->worker, &Worker::beginReconfiguration);
+    connect(this, &Socket::endReconfigurationWorker, _p->worker, &Worker::endReconfiguration);
 
     connect(this, &Socket::joinMulticastGroupWorker, _p->worker, &Worker::joinMulticastGroup);
     connect(this, &Socket::leaveMulticastGroupWorker, _p->worker, &Worker::leaveMulticastGroup);
+    connect(this, &Socket::updateMulticastGroupsWorker, _p->worker, &Worker::updateMulticastGroups);
+    connect(this, &Socket::multicastSourceFilterWorker, _p->worker, &Worker::setMulticastSourceFilter);
+    connect(this, &Socket::multicastEgressInterfacesWorker, _p->worker, &Worker::setMulticastEgressInterfaces);
 
     connect(this, &Socket::joinMulticastInterfaceWorker, _p->worker, &Worker::joinMulticastInterface);
     connect(this, &Socket::leaveMulticastInterfaceWorker, _p->worker, &Worker::leaveMulticastInterface);
@@ -220,33 +537,22 @@ bool Socket::start()
     connect(this, &Socket::separateRxTxSocketsChanged, _p->worker, &Worker::setSeparateRxTxSockets);
     connect(this, &Socket::multicastLoopbackChanged, _p->worker, &Worker::setMulticastLoopback);
     connect(this, &Socket::multicastOutgoingInterfacesChanged, _p->worker, &Worker::setMulticastOutgoingInterfaces);
+    connect(this, &Socket::multicastEgressPolicyChanged, _p->worker, &Worker::setMulticastEgressPolicy);
     connect(this, &Socket::inputEnabledChanged, _p->worker, &Worker::setInputEnabled);
     connect(this, &Socket::watchdogPeriodChanged, _p->worker, &Worker::setWatchdogTimeout);
+    connect(this, &Socket::rxBudgetWeightChanged, _p->worker, &Worker::setRxBudgetWeight);
+    connect(this, &Socket::multicastMembershipsPerSocketChanged, _p->worker, &Worker::setMaxMembershipsPerSocket);
+    connect(this, &Socket::multicastStrictFilteringChanged, _p->worker, &Worker::setMulticastStrictFiltering);
+    connect(this, &Socket::multicastGroupSocketsChanged, _p->worker, &Worker::setMulticastGroupSockets);
 
     connect(this, &Socket::sendDatagramToWorker, _p->worker, &Worker::onSendDatagram, Qt::QueuedConnection);
-    connect(_p->worker, &Worker::datagramReceived, this, &Socket::onDatagramReceived, Qt::QueuedConnection);
-
-    connect(_p->worker, &Worker::isBoundedChanged, this, &Socket::setBounded);
-    connect(_p->worker, &Worker::socketError, this, &Socket::socketError);
-
-    connect(_p->worker, &Worker::rxBytesCounterChanged, this, &Socket::onWorkerRxPerSecondsChanged);
-    connect(_p->worker, &Worker::txBytesCounterChanged, this, &Socket::onWorkerTxPerSecondsChanged);
-    connect(_p->worker, &Worker::rxPacketsCounterChanged, this, &Socket::onWorkerPacketsRxPerSecondsChanged);
-    connect(_p->worker, &Worker::txPacketsCounterChanged, this, &Socket::onWorkerPacketsTxPerSecondsChanged);
-
-    connect(_p->worker, &Worker::multicastGroupJoined, this, &Socket::multicastGroupJoined);
-    connect(_p->worker, &Worker::multicastGroupLeaved, this, &Socket::multicastGroupLeaved);
+    connect(this, &Socket::sendDatagramVToWorker, _p->worker, &Worker::onSendDatagramV, Qt::QueuedConnection);
 
     if(_p->workerThread)
     {
         qCDebug(netudp_socket_log) << "Start worker thread " << _p->workerThread;
         _p->workerThread->start();
     }
-
-    qCDebug(netudp_socket_log) << "Start worker thread " << _p->worker;
-    Q_EMIT startWorker();
-
-    return true;
 }
 
 bool Socket::start(quint16 port)
@@ -267,6 +573,21 @@ bool Socket::restart()
     return start();
 }
 
+void Socket::beginReconfiguration()
+{
+    ++_p->reconfigurationDepth;
+    Q_EMIT beginReconfigurationWorker();
+}
+
+void Socket::endReconfiguration()
+{
+    if(!_p->reconfigurationDepth)
+        return;
+
+    --_p->reconfigurationDepth;
+    Q_EMIT endReconfigurationWorker();
+}
+
 bool Socket::stop()
 {
     if(!isRunning())
@@ -280,6 +601,21 @@ bool Socket::stop()
     resetRxPacketsPerSeconds();
     resetTxPacketsPerSeconds();
 
+    // Return without waiting for the worker, 'stopped' is emitted once it closed its sockets
+    ++_p->pendingWorkerStops;
+
+    // Only the os sockets are closed, the worker, its thread and caches are kept for the next start
+    if(persistentWorker())
+    {
+        ++_p->persistentWorkerStops;
+        _p->workerStarted = false;
+        Q_EMIT stopWorker();
+        disconnect(_p->worker, nullptr, this, nullptr);
+        // Still required to know when the worker is stopped
+        connect(_p->worker, &Worker::stopped, this, &Socket::onWorkerStopped, Qt::QueuedConnection);
+        return true;
+    }
+
     _p->cache.clear();
 
     killWorker();
@@ -315,6 +651,8 @@ bool Socket::leaveMulticastGroup(const QString& groupAddress)
 
     // ) Remove the multicast address from the list, then emit a signal to say the list changed
     _p->multicastListeningGroups.erase(it);
+    _p->multicastIncludedSources.erase(groupAddress);
+    _p->multicastExcludedSources.erase(groupAddress);
     Q_EMIT multicastGroupsChanged(multicastGroups());
 
     Q_EMIT leaveMulticastGroupWorker(groupAddress);
@@ -339,6 +677,142 @@ bool Socket::isMulticastGroupPresent(const QString& groupAddress)
     return _p->multicastListeningGroups.find(groupAddress) != _p->multicastListeningGroups.end();
 }
 
+static bool socketIsValidMulticastSource(const QString& groupAddress, const QString& sourceAddress)
+{
+    const QHostAddress group(groupAddress);
+    const QHostAddress source(sourceAddress);
+    return group.isMulticast() && !source.isNull() && !source.isMulticast() && source.protocol() == group.protocol();
+}
+
+bool Socket::joinMulticastGroup(const QString& groupAddress, const QString& sourceAddress)
+{
+    // ) Check the source can be used with this group
+    if(!socketIsValidMulticastSource(groupAddress, sourceAddress))
+        return false;
+
+    // ) A group joined for any source can't also have a source specific membership
+    const auto present = isMulticastGroupPresent(groupAddress);
+    if(present && _p->multicastIncludedSources.find(groupAddress) == _p->multicastIncludedSources.end())
+        return false;
+
+    // ) Add the source, then send the new filter before the group is joined by the worker
+    if(!_p->multicastIncludedSources[groupAddress].insert(sourceAddress).second)
+        return false;
+
+    sendMulticastSourceFilter(groupAddress);
+
+    if(!present)
+        joinMulticastGroup(groupAddress);
+    return true;
+}
+
+bool Socket::leaveMulticastGroup(const QString& groupAddress, const QString& sourceAddress)
+{
+    const auto it = _p->multicastIncludedSources.find(groupAddress);
+    if(it == _p->multicastIncludedSources.end() || !it->second.erase(sourceAddress))
+        return false;
+
+    // ) Last source, leave the whole group
+    if(it->second.empty())
+        return leaveMulticastGroup(groupAddress);
+
+    sendMulticastSourceFilter(groupAddress);
+    return true;
+}
+
+QStringList Socket::multicastSources(const QString& groupAddress) const
+{
+    const auto it = _p->multicastIncludedSources.find(groupAddress);
+    if(it == _p->multicastIncludedSources.end())
+        return {};
+    return QList<QString>(it->second.begin(), it->second.end());
+}
+
+bool Socket::blockMulticastSource(const QString& groupAddress, const QString& sourceAddress)
+{
+    if(!socketIsValidMulticastSource(groupAddress, sourceAddress))
+        return false;
+
+    // ) Only groups joined for any source can block a source
+    if(!isMulticastGroupPresent(groupAddress) || _p->multicastIncludedSources.find(groupAddress) != _p->multicastIncludedSources.end())
+        return false;
+
+    if(!_p->multicastExcludedSources[groupAddress].insert(sourceAddress).second)
+        return false;
+
+    sendMulticastSourceFilter(groupAddress);
+    return true;
+}
+
+bool Socket::unblockMulticastSource(const QString& groupAddress, const QString& sourceAddress)
+{
+    const auto it = _p->multicastExcludedSources.find(groupAddress);
+    if(it == _p->multicastExcludedSources.end() || !it->second.erase(sourceAddress))
+        return false;
+
+    if(it->second.empty())
+        _p->multicastExcludedSources.erase(it);
+
+    sendMulticastSourceFilter(groupAddress);
+    return true;
+}
+
+QStringList Socket::blockedMulticastSources(const QString& groupAddress) const
+{
+    const auto it = _p->multicastExcludedSources.find(groupAddress);
+    if(it == _p->multicastExcludedSources.end())
+        return {};
+    return QList<QString>(it->second.begin(), it->second.end());
+}
+
+void Socket::sendMulticastSourceFilter(const QString& groupAddress)
+{
+    const auto included = _p->multicastIncludedSources.find(groupAddress);
+    if(included != _p->multicastIncludedSources.end())
+    {
+        Q_EMIT multicastSourceFilterWorker(groupAddress, false, QList<QString>(included->second.begin(), included->second.end()));
+        return;
+    }
+
+    const auto excluded = _p->multicastExcludedSources.find(groupAddress);
+    if(excluded != _p->multicastExcludedSources.end())
+    {
+        Q_EMIT multicastSourceFilterWorker(groupAddress, true, QList<QString>(excluded->second.begin(), excluded->second.end()));
+        return;
+    }
+
+    Q_EMIT multicastSourceFilterWorker(groupAddress, false, {});
+}
+
+bool Socket::setMulticastEgressInterfaces(const QString& groupAddress, const QStringList& interfaces)
+{
+    if(!QHostAddress(groupAddress).isMulticast())
+        return false;
+
+    std::set<QString> egressInterfaces(interfaces.begin(), interfaces.end());
+    const auto it = _p->multicastEgressInterfaces.find(groupAddress);
+
+    // ) Nothing changed
+    if(it == _p->multicastEgressInterfaces.end() ? egressInterfaces.empty() : it->second == egressInterfaces)
+        return false;
+
+    if(egressInterfaces.empty())
+        _p->multicastEgressInterfaces.erase(it);
+    else
+        _p->multicastEgressInterfaces[groupAddress] = egressInterfaces;
+
+    Q_EMIT multicastEgressInterfacesWorker(groupAddress, QList<QString>(egressInterfaces.begin(), egressInterfaces.end()));
+    return true;
+}
+
+QStringList Socket::multicastEgressInterfaces(const QString& groupAddress) const
+{
+    const auto it = _p->multicastEgressInterfaces.find(groupAddress);
+    if(it == _p->multicastEgressInterfaces.end())
+        return {};
+    return QList<QString>(it->second.begin(), it->second.end());
+}
+
 bool Socket::joinMulticastInterface(const QString& name)
 {
     // ) Check that the address isn't already registered
@@ -393,6 +867,7 @@ void Socket::clearRxCounter()
     resetRxPacketsTotal();
     resetRxBytesPerSeconds();
     resetRxBytesTotal();
+    resetRxBudgetDroppedTotal();
 }
 
 void Socket::clearTxCounter()
@@ -401,6 +876,8 @@ void Socket::clearTxCounter()
     resetTxPacketsTotal();
     resetTxBytesPerSeconds();
     resetTxBytesTotal();
+    resetTxMulticastPacketsTotal();
+    resetTxMulticastWritesTotal();
 }
 
 void Socket::clearRxInvalidCounter()
@@ -408,10 +885,23 @@ void Socket::clearRxInvalidCounter()
     resetRxInvalidPacketTotal();
 }
 
+void Socket::clearWatchdogCounter()
+{
+    _p->watchdogRestarts.clear();
+    ISocket::clearWatchdogCounter();
+}
+
 void Socket::clearCounters()
 {
     clearRxCounter();
     clearTxCounter();
+    clearWatchdogCounter();
+}
+
+quint64 Socket::watchdogRestarts(netudp::WatchdogComponent component) const
+{
+    const auto it = _p->watchdogRestarts.find(component);
+    return it == _p->watchdogRestarts.end() ? 0 : it->second;
 }
 
 Worker* Socket::createWorker()
@@ -457,6 +947,27 @@ bool Socket::sendDatagram(const char* buffer, const size_t length, const QString
     return sendDatagram(reinterpret_cast<const uint8_t*>(buffer), length, address, port, ttl);
 }
 
+bool Socket::sendDatagram(const QByteArray& data, const QString& address, const uint16_t port, const uint8_t ttl)
+{
+    if(!isSendDatagramAllowed())
+        return false;
+
+    if(data.isEmpty())
+    {
+        qCWarning(netudp_socket_log) << "Fail to send datagram because the length is <= 0";
+        return false;
+    }
+
+    auto datagram = std::make_shared<ByteArrayDatagram>(data);
+    datagram->destinationAddress = address;
+    datagram->destinationPort = port;
+    datagram->ttl = ttl;
+
+    Q_EMIT sendDatagramToWorker(std::move(datagram));
+
+    return true;
+}
+
 bool Socket::sendDatagram(std::shared_ptr<Datagram> datagram, const QString& address, const uint16_t port, const uint8_t ttl)
 {
     if(!datagram)
@@ -476,7 +987,8 @@ bool Socket::sendDatagram(std::shared_ptr<Datagram> datagram)
     if(!isSendDatagramAllowed())
         return false;
 
-    if(!datagram || !datagram->buffer())
+    // Const access to never detach implicitly shared data
+    if(!datagram || !std::as_const(*datagram).buffer())
     {
         qCWarning(netudp_socket_log) << "Fail to send null datagram";
         return false;
@@ -493,6 +1005,33 @@ bool Socket::sendDatagram(std::shared_ptr<Datagram> datagram)
     return true;
 }
 
+bool Socket::sendDatagramV(ConstBufferList buffers, const QString& address, const uint16_t port, const uint8_t ttl)
+{
+    if(!isSendDatagramAllowed())
+        return false;
+
+    std::size_t length = 0;
+    for(const auto& buffer: buffers)
+    {
+        if(!buffer.data && buffer.length)
+        {
+            qCWarning(netudp_socket_log) << "Fail to send datagram because one of the buffer is null";
+            return false;
+        }
+        length += buffer.length;
+    }
+
+    if(length <= 0)
+    {
+        qCWarning(netudp_socket_log) << "Fail to send datagram because the length is <= 0";
+        return false;
+    }
+
+    Q_EMIT sendDatagramVToWorker(std::move(buffers), address, port, ttl);
+
+    return true;
+}
+
 #ifdef NETUDP_ENABLE_QML
 bool Socket::sendDatagram(QJSValue datagram)
 {
@@ -552,10 +1091,8 @@ bool Socket::sendDatagram(QJSValue datagram)
     {
         if(property.isString())
         {
-            const auto dataAsString = property.toString();
-            const auto dataAsBytes = dataAsString.toLatin1();
-            sharedDatagram = makeDatagram(dataAsBytes.length());
-            memcpy(sharedDatagram->buffer(), dataAsBytes.constData(), dataAsBytes.length());
+            // Adopt the latin1 conversion instead of copying it into a recycled datagram
+            sharedDatagram = std::make_shared<ByteArrayDatagram>(property.toString().toLatin1());
         }
         else if(property.isArray())
         {
@@ -583,7 +1120,7 @@ bool Socket::sendDatagram(QJSValue datagram)
     sharedDatagram->destinationPort = port;
     sharedDatagram->ttl = ttl;
 
-    return sendDatagram(sharedDatagram);
+    return sendDatagram(std::move(sharedDatagram));
 }
 #endif
 
@@ -606,6 +1143,27 @@ bool Socket::isSendDatagramAllowed() const
     return true;
 }
 
+void Socket::onWorkerDatagramReceived(const SharedDatagram& datagram)
+{
+    // Received by a worker being stopped, or by a previous worker, and delivered late
+    if(!isRunning() || _p->persistentWorkerStops > 0 || sender() != _p->worker)
+        return;
+
+    onDatagramReceived(datagram);
+}
+
+void Socket::onWorkerStopped()
+{
+    if(_p->persistentWorkerStops > 0 && sender() == _p->worker)
+        --_p->persistentWorkerStops;
+
+    if(_p->pendingWorkerStops <= 0)
+        return;
+
+    if(--_p->pendingWorkerStops == 0)
+        Q_EMIT stopped();
+}
+
 void Socket::onDatagramReceived(const SharedDatagram& datagram)
 {
     Q_CHECK_PTR(datagram.get());
@@ -669,6 +1227,39 @@ void Socket::onWorkerRxInvalidPacketsCounterChanged(const quint64 rxPackets)
     setRxInvalidPacketTotal(rxInvalidPacketTotal() + rxPackets);
 }
 
+void Socket::onWorkerRxBudgetDroppedCounterChanged(const quint64 rxPackets)
+{
+    if(rxPackets)
+        setRxBudgetDroppedTotal(rxBudgetDroppedTotal() + rxPackets);
+}
+
+void Socket::onWorkerTxMulticastCounterChanged(const quint64 txPackets, const quint64 txWrites)
+{
+    if(txPackets)
+        setTxMulticastPacketsTotal(txMulticastPacketsTotal() + txPackets);
+    if(txWrites)
+        setTxMulticastWritesTotal(txMulticastWritesTotal() + txWrites);
+}
+
+void Socket::onWorkerComponentRestarted(
+    netudp::WatchdogComponent component, const QString& interfaceName, const QString& group, const QString& reason)
+{
+    ++_p->watchdogRestarts[component];
+    setWatchdogRestartsTotal(watchdogRestartsTotal() + 1);
+    setLastWatchdogRestartReason(reason);
+    Q_EMIT watchdogRestarted(component, interfaceName, group, reason);
+}
+
+void Socket::onWorkerCacheStatisticsChanged(const netudp::DatagramPoolStatistics& statistics)
+{
+    // Adapt at the pace of the worker statistics, with the time actually elapsed
+    if(_p->cacheAdaptTimer.isValid())
+        _p->cache.adapt(quint64(_p->cacheAdaptTimer.restart()));
+
+    setRxCacheStatistics(statistics);
+    setTxCacheStatistics(_p->cache.statistics());
+}
+
 }
 
 #include "moc_Socket.cpp"
@@ -12,6 +12,10 @@
 #include <NetUdp/Export.hpp>
 #include <NetUdp/Property.hpp>
 #include <NetUdp/Datagram.hpp>
+#include <NetUdp/ConstBuffer.hpp>
+#include <NetUdp/DatagramPool.hpp>
+#include <NetUdp/MulticastEgressPolicy.hpp>
+#include <NetUdp/WatchdogComponent.hpp>
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
@@ -40,7 +44,8 @@ protected:
     // You shouldn't try to send any datagram if the socket isn't bounded.
     NETUDP_PROPERTY_RO(bool, isBounded, Bounded);
 
-    // If bind failed, or if a network error occur, the socket will restart in watchdogPeriod (ms)
+    // If bind failed, or if a network error occur, the failing part of the socket is restarted (see WatchdogComponent).
+    // The restart delay start at a few ms and double at each consecutive failure, up to watchdogPeriod (ms).
     NETUDP_PROPERTY_D(quint64, watchdogPeriod, WatchdogPeriod, 5000);
 
     // ──────── ATTRIBUTE ────────
@@ -73,6 +78,37 @@ protected:
     // You need to subclass netudp::Worker to have any benefit.
     NETUDP_PROPERTY(bool, useWorkerThread, UseWorkerThread);
 
+    // Keep the worker, its thread and caches between stop and start, only os sockets are closed.
+    // When disabled, they are destroyed by stop and created again by start.
+    NETUDP_PROPERTY_D(bool, persistentWorker, PersistentWorker, true);
+
+    // Number of datagrams allocated in each size class of the socket and worker caches at start, instead of on the first packets.
+    // Bounded by the cache size of each class. 0 (default) allocate on demand. Applied at next start.
+    NETUDP_PROPERTY(quint64, prewarmCacheCount, PrewarmCacheCount);
+
+    // Memory backing prewarmed caches (Linux only). Applied at next start.
+    NETUDP_PROPERTY(netudp::DatagramPool::HugePages, cacheHugePages, CacheHugePages);
+
+    // Size socket and worker caches from the traffic: grow to the peak of datagrams in use,
+    // and decay after 'adaptiveCacheIdleTimeout' ms below that peak. See DatagramPoolAdaptivePolicy. Applied at next start.
+    NETUDP_PROPERTY(bool, adaptiveCache, AdaptiveCache);
+    NETUDP_PROPERTY_D(quint64, adaptiveCacheIdleTimeout, AdaptiveCacheIdleTimeout, 30000);
+
+    // Share of the process wide RxMemoryBudget this socket can fill before dropping received datagrams, in [0, 1].
+    // When the budget is tight, sockets with the lowest weight drop first. Unused while the budget capacity is 0.
+    NETUDP_PROPERTY_D(qreal, rxBudgetWeight, RxBudgetWeight, 1.0);
+
+    // Multicast memberships joined on one rx socket, another socket is bound to rxPort when it is full.
+    // Linux default limit is net.ipv4.igmp_max_memberships (20). Only affect groups joined after a change.
+    NETUDP_PROPERTY_D(quint32, multicastMembershipsPerSocket, MulticastMembershipsPerSocket, 20);
+
+    // Linux deliver to a socket bound to AnyIPv4:rxPort every group joined on that port by any socket of the host.
+    // When enabled, IP_MULTICAST_ALL is disabled so only groups in 'multicastGroups' are received.
+    NETUDP_PROPERTY(bool, multicastStrictFiltering, MulticastStrictFiltering);
+    // Bind one rx socket per group address. The kernel then only deliver a group to its socket, even for
+    // groups joined elsewhere. Not supported on Windows, where it behave as 'multicastStrictFiltering'.
+    NETUDP_PROPERTY(bool, multicastGroupSockets, MulticastGroupSockets);
+
     // ──────── ATTRIBUTE MULTICAST INPUT ────────
 protected:
     // List of all multicast group the socket is listening to
@@ -100,6 +136,9 @@ protected:
     // Linux: Should be set on sender
     NETUDP_PROPERTY(bool, multicastLoopback, MulticastLoopback);
 
+    // Interfaces, among 'multicastOutgoingInterfaces', on which each multicast datagram is written. See MulticastEgressPolicy.
+    NETUDP_PROPERTY(netudp::MulticastEgressPolicy, multicastEgressPolicy, MulticastEgressPolicy);
+
     // ──────── STATUS ────────
 protected:
     NETUDP_PROPERTY_RO(quint64, rxBytesPerSeconds, RxBytesPerSeconds);
@@ -113,6 +152,22 @@ protected:
     NETUDP_PROPERTY_RO(quint64, txPacketsTotal, TxPacketsTotal);
 
     NETUDP_PROPERTY_RO(quint64, rxInvalidPacketTotal, RxInvalidPacketTotal);
+    // Datagrams dropped because RxMemoryBudget was exhausted for rxBudgetWeight
+    NETUDP_PROPERTY_RO(quint64, rxBudgetDroppedTotal, RxBudgetDroppedTotal);
+
+    // Multicast datagrams sent, and writes done on multicast tx sockets to send them.
+    // The ratio of both is the multicast fan-out, ie the average count of interfaces a datagram is sent on.
+    NETUDP_PROPERTY_RO(quint64, txMulticastPacketsTotal, TxMulticastPacketsTotal);
+    NETUDP_PROPERTY_RO(quint64, txMulticastWritesTotal, TxMulticastWritesTotal);
+
+    // Restarts done by the watchdog, of any component, and the failure that caused the last one
+    NETUDP_PROPERTY_RO(quint64, watchdogRestartsTotal, WatchdogRestartsTotal);
+    NETUDP_PROPERTY_RO(QString, lastWatchdogRestartReason, LastWatchdogRestartReason);
+
+    // Counters of the worker cache, that hold received datagrams. Refreshed every second while running.
+    NETUDP_PROPERTY_RO(netudp::DatagramPoolStatistics, rxCacheStatistics, RxCacheStatistics);
+    // Counters of the socket cache, used by makeDatagram to send datagrams. Refreshed with rxCacheStatistics.
+    NETUDP_PROPERTY_RO(netudp::DatagramPoolStatistics, txCacheStatistics, TxCacheStatistics);
 
     // ──────── C++ API ────────
 public Q_SLOTS:
@@ -122,11 +177,37 @@ public Q_SLOTS:
     virtual bool stop() = 0;
     virtual bool restart() = 0;
 
+    // Apply every change of rxAddress, rxPort, txPort, inputEnabled, separateRxTxSockets and multicast filtering made
+    // between both calls at once, when the last 'endReconfiguration' is called. A running socket isn't restarted:
+    // new sockets are bound and join the multicast groups before previous ones are closed, multicast tx sockets are kept.
+    // Default implementations do nothing, each change is applied when made.
+    virtual void beginReconfiguration();
+    virtual void endReconfiguration();
+
     virtual bool joinMulticastGroup(const QString& groupAddress) = 0;
     virtual bool leaveMulticastGroup(const QString& groupAddress) = 0;
     virtual bool leaveAllMulticastGroups() = 0;
     virtual bool isMulticastGroupPresent(const QString& groupAddress) = 0;
 
+    // Source specific multicast: only receive datagrams sent by 'sourceAddress' to 'groupAddress'.
+    // Can be called for several sources, the group is joined with the first one, and left with the last one.
+    // Fail if the group is already joined for any source.
+    // Default implementations don't support source filtering: they fail, and report no source.
+    virtual bool joinMulticastGroup(const QString& groupAddress, const QString& sourceAddress);
+    virtual bool leaveMulticastGroup(const QString& groupAddress, const QString& sourceAddress);
+    virtual QStringList multicastSources(const QString& groupAddress) const;
+
+    // Filter out 'sourceAddress' from a group joined for any source.
+    virtual bool blockMulticastSource(const QString& groupAddress, const QString& sourceAddress);
+    virtual bool unblockMulticastSource(const QString& groupAddress, const QString& sourceAddress);
+    virtual QStringList blockedMulticastSources(const QString& groupAddress) const;
+
+    // Only send datagrams to 'groupAddress' on 'interfaces', whatever multicastEgressPolicy is.
+    // Interfaces without a multicast tx socket are skipped, the policy is used if none is left. An empty list remove the group.
+    // Default implementations don't support explicit interfaces: they fail, and report none.
+    virtual bool setMulticastEgressInterfaces(const QString& groupAddress, const QStringList& interfaces);
+    virtual QStringList multicastEgressInterfaces(const QString& groupAddress) const;
+
     virtual bool joinMulticastInterface(const QString& name) = 0;
     virtual bool leaveMulticastInterface(const QString& name) = 0;
     virtual bool leaveAllMulticastInterfaces() = 0;
@@ -135,8 +216,12 @@ public Q_SLOTS:
     virtual void clearRxCounter() = 0;
     virtual void clearTxCounter() = 0;
     virtual void clearRxInvalidCounter() = 0;
+    virtual void clearWatchdogCounter();
     virtual void clearCounters() = 0;
 
+    // Restarts of 'component' done by the watchdog. Default implementation report none.
+    virtual quint64 watchdogRestarts(netudp::WatchdogComponent component) const;
+
 #ifdef NETUDP_ENABLE_QML
     // Example:
     // ```js
@@ -156,12 +241,24 @@ public:
         const uint8_t* buffer, const size_t length, const QString& address, const uint16_t port, const uint8_t ttl = 0) = 0;
     virtual bool sendDatagram(
         const char* buffer, const size_t length, const QString& address, const uint16_t port, const uint8_t ttl = 0) = 0;
+    // QByteArray is adopted without any deep copy, only its reference counter is incremented.
+    // Default implementation copy the data with the 'const char*' overload.
+    virtual bool sendDatagram(const QByteArray& data, const QString& address, const uint16_t port, const uint8_t ttl = 0);
     virtual bool sendDatagram(std::shared_ptr<Datagram> datagram, const QString& address, const uint16_t port, const uint8_t ttl = 0) = 0;
     virtual bool sendDatagram(std::shared_ptr<Datagram> datagram) = 0;
 
+    // Send every buffers as a single datagram without concatenating them (scatter/gather io).
+    // Each buffer should be kept alive by its 'owner' until the datagram is written by the worker.
+    // Default implementation concatenate the buffers and call sendDatagram.
+    virtual bool sendDatagramV(ConstBufferList buffers, const QString& address, const uint16_t port, const uint8_t ttl = 0);
+
     // ──────── SIGNALS ────────
 Q_SIGNALS:
     void socketError(int error, const QString description);
+    // Emitted once the worker closed its sockets after 'stop'. 'stop' itself never wait for the worker.
+    void stopped();
+    // 'interfaceName' is set for multicast components, and 'group' for MulticastMembership
+    void watchdogRestarted(netudp::WatchdogComponent component, QString interfaceName, QString group, QString reason);
 
     void multicastGroupJoined(QString group, QString interfaceName);
     void multicastGroupLeaved(QString group, QString interfaceName);
@@ -190,6 +287,14 @@ protected:
     // Set _worker & _workerThread to nullptr
     void killWorker();
 
+private:
+    // Create the worker, move it to its thread if required, and connect everything the socket send to it
+    void spawnWorker();
+
+private:
+    // Send the source filter of 'groupAddress' to the worker, or clear it when the group has no source
+    void sendMulticastSourceFilter(const QString& groupAddress);
+
 public:
     bool setUseWorkerThread(const bool& enabled) override;
 
@@ -207,11 +312,25 @@ public Q_SLOTS:
     bool restart() override final;
     bool stop() override;
 
+    void beginReconfiguration() override final;
+    void endReconfiguration() override final;
+
     bool joinMulticastGroup(const QString& groupAddress) override final;
     bool leaveMulticastGroup(const QString& groupAddress) override final;
     bool leaveAllMulticastGroups() override final;
     bool isMulticastGroupPresent(const QString& groupAddress) override final;
 
+    bool joinMulticastGroup(const QString& groupAddress, const QString& sourceAddress) override final;
+    bool leaveMulticastGroup(const QString& groupAddress, const QString& sourceAddress) override final;
+    QStringList multicastSources(const QString& groupAddress) const override final;
+
+    bool blockMulticastSource(const QString& groupAddress, const QString& sourceAddress) override final;
+    bool unblockMulticastSource(const QString& groupAddress, const QString& sourceAddress) override final;
+    QStringList blockedMulticastSources(const QString& groupAddress) const override final;
+
+    bool setMulticastEgressInterfaces(const QString& groupAddress, const QStringList& interfaces) override final;
+    QStringList multicastEgressInterfaces(const QString& groupAddress) const override final;
+
     bool joinMulticastInterface(const QString& name) override final;
     bool leaveMulticastInterface(const QString& name) override final;
     bool leaveAllMulticastInterfaces() override final;
@@ -220,8 +339,11 @@ public Q_SLOTS:
     void clearRxCounter() override final;
     void clearTxCounter() override final;
     void clearRxInvalidCounter() override final;
+    void clearWatchdogCounter() override final;
     void clearCounters() override final;
 
+    quint64 watchdogRestarts(netudp::WatchdogComponent component) const override final;
+
     // ──────── CUSTOM WORKER API ────────
 protected:
     virtual Worker* createWorker();
@@ -235,8 +357,10 @@ public:
     bool sendDatagram(
         const uint8_t* buffer, const size_t length, const QString& address, const uint16_t port, const uint8_t ttl = 0) override;
     bool sendDatagram(const char* buffer, const size_t length, const QString& address, const uint16_t port, const uint8_t ttl = 0) override;
+    bool sendDatagram(const QByteArray& data, const QString& address, const uint16_t port, const uint8_t ttl = 0) override;
     bool sendDatagram(std::shared_ptr<Datagram> datagram, const QString& address, const uint16_t port, const uint8_t ttl = 0) override;
     bool sendDatagram(std::shared_ptr<Datagram> datagram) override;
+    bool sendDatagramV(ConstBufferList buffers, const QString& address, const uint16_t port, const uint8_t ttl = 0) override;
 #ifdef NETUDP_ENABLE_QML
     bool sendDatagram(QJSValue datagram) override;
 #endif
@@ -255,17 +379,30 @@ private Q_SLOTS:
     void onWorkerPacketsRxPerSecondsChanged(const quint64 rxPackets);
     void onWorkerPacketsTxPerSecondsChanged(const quint64 txPackets);
     void onWorkerRxInvalidPacketsCounterChanged(const quint64 rxPackets);
+    void onWorkerRxBudgetDroppedCounterChanged(const quint64 rxPackets);
+    void onWorkerTxMulticastCounterChanged(const quint64 txPackets, const quint64 txWrites);
+    void onWorkerComponentRestarted(
+        netudp::WatchdogComponent component, const QString& interfaceName, const QString& group, const QString& reason);
+    void onWorkerCacheStatisticsChanged(const netudp::DatagramPoolStatistics& statistics);
+    void onWorkerDatagramReceived(const SharedDatagram& datagram);
+    void onWorkerStopped();
 
     // ──────── PRIVATE WORKER COMMUNICATION (TO) ────────
 Q_SIGNALS:
     void startWorker();
     void stopWorker();
     void restartWorker();
+    void beginReconfigurationWorker();
+    void endReconfigurationWorker();
     void joinMulticastGroupWorker(const QString address);
     void leaveMulticastGroupWorker(const QString address);
+    void updateMulticastGroupsWorker(const QStringList joined, const QStringList left);
+    void multicastSourceFilterWorker(const QString address, const bool exclude, const QStringList sources);
+    void multicastEgressInterfacesWorker(const QString address, const QStringList interfaces);
     void joinMulticastInterfaceWorker(const QString address);
     void leaveMulticastInterfaceWorker(const QString address);
     void sendDatagramToWorker(netudp::SharedDatagram datagram);
+    void sendDatagramVToWorker(netudp::ConstBufferList buffers, const QString address, const quint16 port, const quint8 ttl);
 
 private:
     std::unique_ptr<SocketPrivate> _p;
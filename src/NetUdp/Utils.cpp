@@ -35,6 +35,11 @@ static void NetUdp_registerTypes()
     qRegisterMetaType<netudp::SharedDatagram>("netudp::SharedDatagram");
     qRegisterMetaType<netudp::SharedDatagram>("udp::SharedDatagram");
     qRegisterMetaType<netudp::SharedDatagram>("SharedDatagram");
+    qRegisterMetaType<netudp::ConstBufferList>("netudp::ConstBufferList");
+    qRegisterMetaType<netudp::DatagramPoolStatistics>("netudp::DatagramPoolStatistics");
+    qRegisterMetaType<netudp::DatagramPool::HugePages>("netudp::DatagramPool::HugePages");
+    qRegisterMetaType<netudp::MulticastEgressPolicy>("netudp::MulticastEgressPolicy");
+    qRegisterMetaType<netudp::WatchdogComponent>("netudp::WatchdogComponent");
 }
 
 static void NetUdp_registerTypes(const char* uri, const quint8 major, const quint8 minor)
@@ -0,0 +1,31 @@
+// Copyright 2019 - 2021 Olivier Le Doeuff
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright noticeand this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __NETUDP_WATCHDOG_COMPONENT_HPP__
+#define __NETUDP_WATCHDOG_COMPONENT_HPP__
+
+#include <QtCore/QMetaType>
+
+namespace netudp {
+
+// Part of the worker restarted by the watchdog after a failure.
+// Each component is restarted on its own, with a delay that double at each consecutive failure, up to Socket::watchdogPeriod.
+enum class WatchdogComponent
+{
+    Worker, // Every socket, like a stop followed by a start. Used when binding fail
+    RxSocket, // Socket bound to rxAddress:rxPort, with its memberships. It also send datagrams without separateRxTxSockets
+    TxSocket, // Unicast tx socket, when separateRxTxSockets
+    MulticastTxSocket, // Multicast tx socket of a single interface
+    MulticastMembership, // Membership of a group on a single interface
+};
+
+}
+
+Q_DECLARE_METATYPE(netudp::WatchdogComponent);
+
+#endif
@@ -8,16 +8,27 @@
 
 #include <NetUdp/Worker.hpp>
 #include <NetUdp/InterfacesProvider.hpp>
-#include <NetUdp/RecycledDatagram.hpp>
+#include <NetUdp/InterfacesMonitor.hpp>
+#include <NetUdp/DatagramPool.hpp>
+#include <NetUdp/NativeSocket.hpp>
+#include <NetUdp/RxMemoryBudget.hpp>
+#include <NetUdp/MulticastTxSocketPool.hpp>
 #include <QtCore/QTimer>
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QRandomGenerator>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QDebug>
 #include <QtNetwork/QUdpSocket>
 #include <QtNetwork/QNetworkInterface>
 #include <QtNetwork/QNetworkDatagram>
-#include <Recycler/Circular.hpp>
 #include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 
 Q_LOGGING_CATEGORY(netudp_worker_log, "netudp.worker");
 
@@ -25,17 +36,195 @@ namespace netudp {
 
 static const quint64 disableSocketTimeout = 10000;
 
+// A multicast group joined on an iface. IPv4 groups are stored as v4 mapped IPv6 addresses.
+struct WorkerMembership
+{
+    Q_IPV6ADDR group;
+    quint16 iface;
+
+    bool operator==(const WorkerMembership& other) const
+    {
+        return iface == other.iface && std::memcmp(&group, &other.group, sizeof(group)) == 0;
+    }
+};
+
+struct WorkerMembershipHash
+{
+    std::size_t operator()(const WorkerMembership& membership) const
+    {
+        return qHashBits(&membership.group, sizeof(membership.group), membership.iface);
+    }
+};
+
+// Sources of a group, either the only ones received (source specific membership), or filtered out of an any source membership.
+struct WorkerSourceFilter
+{
+    bool exclude = false;
+    std::vector<QHostAddress> sources;
+};
+
+using WorkerSourceFilterPtr = std::shared_ptr<const WorkerSourceFilter>;
+
+static bool workerJoinNativeMembership(
+    qintptr descriptor, const QHostAddress& group, int ifaceIndex, const WorkerSourceFilter* filter, QString& error)
+{
+    if(!filter)
+        return NativeSocket::joinMulticastGroup(descriptor, group, ifaceIndex, &error);
+
+    if(!filter->exclude)
+    {
+        for(std::size_t i = 0; i < filter->sources.size(); ++i)
+        {
+            if(!NativeSocket::joinMulticastSource(descriptor, group, filter->sources[i], ifaceIndex, &error))
+            {
+                // Don't keep a partial membership
+                for(std::size_t j = 0; j < i; ++j)
+                    NativeSocket::leaveMulticastSource(descriptor, group, filter->sources[j], ifaceIndex);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if(!NativeSocket::joinMulticastGroup(descriptor, group, ifaceIndex, &error))
+        return false;
+
+    for(const auto& source: filter->sources)
+    {
+        if(!NativeSocket::blockMulticastSource(descriptor, group, source, ifaceIndex, &error))
+        {
+            NativeSocket::leaveMulticastGroup(descriptor, group, ifaceIndex);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool workerLeaveNativeMembership(
+    qintptr descriptor, const QHostAddress& group, int ifaceIndex, const WorkerSourceFilter* filter, QString& error)
+{
+    if(!filter || filter->exclude)
+        return NativeSocket::leaveMulticastGroup(descriptor, group, ifaceIndex, &error);
+
+    bool success = true;
+    for(const auto& source: filter->sources)
+    {
+        if(!NativeSocket::leaveMulticastSource(descriptor, group, source, ifaceIndex, &error))
+            success = false;
+    }
+    return success;
+}
+
+// Iface on which groups can be joined
+static bool workerMulticastInterfaceValid(const IInterface* iface, bool multicastLoopback)
+{
+    return iface && iface->isValid() && iface->isRunning() && iface->isUp()
+           && (iface->canMulticast() || (multicastLoopback && iface->isLoopBack()));
+}
+
+// Qt need a QNetworkInterface to join a group, only built for memberships that can't be joined natively
+static QNetworkInterface workerNetworkInterface(const QString& name, int index)
+{
+    return index > 0 ? QNetworkInterface::interfaceFromIndex(index) : QNetworkInterface::interfaceFromName(name);
+}
+
+// Linux deliver every group joined on the port by any socket of the host, unless IP_MULTICAST_ALL is disabled.
+// The option doesn't exist elsewhere.
+static bool workerDisableMulticastAll(qintptr descriptor)
+{
+#ifdef Q_OS_LINUX
+    return NativeSocket::setMulticastAll(descriptor, false);
+#else
+    Q_UNUSED(descriptor);
+    return true;
+#endif
+}
+
+// Apply only the sources that changed between 'previous' and 'next' to a membership joined with 'previous'.
+// On failure, the group is left on the iface, whatever sources were already applied.
+static bool workerUpdateNativeMembership(qintptr descriptor,
+    const QHostAddress& group,
+    int ifaceIndex,
+    const WorkerSourceFilter* previous,
+    const WorkerSourceFilter* next,
+    QString& error)
+{
+    const bool previousAnySource = !previous || previous->exclude;
+    const bool nextAnySource = !next || next->exclude;
+
+    // Switching between any source and source specific require a new membership
+    if(previousAnySource != nextAnySource)
+    {
+        workerLeaveNativeMembership(descriptor, group, ifaceIndex, previous, error);
+        return workerJoinNativeMembership(descriptor, group, ifaceIndex, next, error);
+    }
+
+    static const std::vector<QHostAddress> noSources;
+    const auto& previousSources = previous ? previous->sources : noSources;
+    const auto& nextSources = next ? next->sources : noSources;
+    const auto contains = [](const std::vector<QHostAddress>& sources, const QHostAddress& source)
+    { return std::find(sources.begin(), sources.end(), source) != sources.end(); };
+
+    // Add sources first, so a source specific membership is never left in between
+    bool success = true;
+    for(auto it = nextSources.begin(); success && it != nextSources.end(); ++it)
+    {
+        if(contains(previousSources, *it))
+            continue;
+        success = nextAnySource ? NativeSocket::blockMulticastSource(descriptor, group, *it, ifaceIndex, &error)
+                                : NativeSocket::joinMulticastSource(descriptor, group, *it, ifaceIndex, &error);
+    }
+
+    for(auto it = previousSources.begin(); success && it != previousSources.end(); ++it)
+    {
+        if(contains(nextSources, *it))
+            continue;
+        success = nextAnySource ? NativeSocket::unblockMulticastSource(descriptor, group, *it, ifaceIndex, &error)
+                                : NativeSocket::leaveMulticastSource(descriptor, group, *it, ifaceIndex, &error);
+    }
+
+    if(success)
+        return true;
+
+    // Don't keep a membership with an unknown filter
+    if(nextAnySource)
+    {
+        NativeSocket::leaveMulticastGroup(descriptor, group, ifaceIndex);
+        return false;
+    }
+
+    for(const auto& source: previousSources)
+        NativeSocket::leaveMulticastSource(descriptor, group, source, ifaceIndex);
+    for(const auto& source: nextSources)
+    {
+        if(!contains(previousSources, source))
+            NativeSocket::leaveMulticastSource(descriptor, group, source, ifaceIndex);
+    }
+    return false;
+}
+
 struct WorkerPrivate
 {
     using MulticastGroupList = std::set<QString>;
     using MulticastInterfaceList = std::set<QString>;
-    using InterfaceToMulticastSocket = std::map<QString, QUdpSocket*>;
+    // Socket borrowed from MulticastTxSocketPool, with the key it was borrowed with
+    struct MulticastTxSocket
+    {
+        qintptr descriptor = -1;
+        quint8 ttl = 0;
+        bool loopback = false;
+        // Os index of the iface, to match the route table
+        int index = 0;
+    };
+    using InterfaceToMulticastSocket = std::map<QString, MulticastTxSocket>;
 
     // ──────── ATTRIBUTE ────────
     QUdpSocket* socket = nullptr;
     QUdpSocket* rxSocket = nullptr;
     QTimer* watchdog = nullptr;
-    recycler::Circular<RecycledDatagram> cache;
+    DatagramPool cache;
+    std::size_t cachePrewarmCount = 0;
+    qreal rxBudgetWeight = 1;
     bool isBounded = false;
     quint64 watchdogTimeout = 5000;
     QString rxAddress;
@@ -50,7 +239,7 @@ struct WorkerPrivate
     // Incoming ifaces for multicast packets that are going to be listened.
     // If empty, then every ifaces available on your system that support multicast are going to be listened.
     // This set doesn't reflect the ifaces that are really joined. If you want to know which ifaces are really joined
-    // or which one failed to joined, then check `_failedToJoinIfaces` & '_joinedIfaces'
+    // or which one failed to joined, then check 'memberships' & 'failedMemberships'
     MulticastInterfaceList incomingMulticastInterfaces;
     MulticastInterfaceList allMulticastInterfaces;
 
@@ -59,15 +248,160 @@ struct WorkerPrivate
         return incomingMulticastInterfaces.empty() ? allMulticastInterfaces : incomingMulticastInterfaces;
     }
 
-    // Keep track of all multicast ifaces, to know which one are available
-    //std::set<QString> allMulticastInterfaces;
+    // ─── Multicast - Input shards ───
+
+    // Os limit the memberships of a socket (Linux: net.ipv4.igmp_max_memberships, 20 by default).
+    // Memberships are spread over several rx sockets bound to the same address and port.
+    // The first shard is rxSocket(), others are created once every shard is full, and live until 'onStop'.
+    // With 'multicastGroupSockets', each group get its own shard bound to the group address, that is released with the group.
+    struct MembershipShard
+    {
+        QUdpSocket* socket = nullptr;
+        quint32 memberships = 0;
+        // Null for shards bound to rxHostAddress()
+        QHostAddress group;
+    };
+    std::vector<MembershipShard> membershipShards;
+    quint32 maxMembershipsPerSocket = 20;
+
+    // Disable IP_MULTICAST_ALL on every rx socket, so only groups joined by this worker reach 'readPendingDatagrams'.
+    bool multicastStrictFiltering = false;
+    // Bind a socket per group, to also filter out groups joined by other sockets on the port (Linux/macOS only).
+    bool multicastGroupSockets = false;
+
+    // Group sockets are useless if rxSocket() still receive the groups they joined
+    bool strictMulticastFiltering() const
+    {
+        return multicastStrictFiltering || multicastGroupSockets;
+    }
 
-    // Keep track of group that were joined on each ifaces
-    std::map<QString, MulticastGroupList> joinedMulticastGroups;
+    bool bindMulticastGroupSockets() const
+    {
+#ifdef Q_OS_WIN
+        // Binding to a multicast address isn't supported
+        return false;
+#else
+        return multicastGroupSockets;
+#endif
+    }
 
-    // Keep track of the ifaces that couldn't be joined, to retry periodically when the iface will be up again
+    // Every (group, iface) joined, with its shard and the source filter it was joined with.
+    // Ifaces are referenced by a small id, see 'membershipInterfaceId'.
+    struct MembershipState
+    {
+        quint16 shard = 0;
+        // Os index of the iface when the group was joined
+        int ifaceIndex = 0;
+        // Joined with a setsockopt, otherwise by Qt
+        bool native = false;
+        WorkerSourceFilterPtr filter;
+        // As given by the user, for signals and logs
+        QString group;
+    };
+    std::unordered_map<WorkerMembership, MembershipState, WorkerMembershipHash> memberships;
+
+    // Memberships that couldn't be joined, to retry periodically when the iface will be up again.
     // See 'startListeningMulticastInterfaceWatcher'
-    std::map<QString, MulticastGroupList> failedJoiningMulticastGroup;
+    std::unordered_map<WorkerMembership, QString, WorkerMembershipHash> failedMemberships;
+
+    // Source filter of groups in 'multicastGroups', applied each time a group is joined on an iface.
+    // See 'setMulticastSourceFilter'.
+    std::map<QString, WorkerSourceFilterPtr> multicastSourceFilters;
+
+    WorkerSourceFilterPtr multicastSourceFilter(const QString& group) const
+    {
+        const auto it = multicastSourceFilters.find(group);
+        return it == multicastSourceFilters.end() ? nullptr : it->second;
+    }
+
+    // Ifaces of 'memberships' and 'failedMemberships', indexed by id.
+    // Counters let the watcher only walk the memberships of an iface that changed.
+    struct MembershipInterface
+    {
+        QString name;
+        quint32 joined = 0;
+        quint32 failed = 0;
+    };
+    std::vector<MembershipInterface> membershipInterfaces;
+    QHash<QString, quint16> membershipInterfaceIds;
+
+    // Generation of the last snapshot checked by 'checkListeningMulticastInterfaces'
+    quint64 listeningInterfacesGeneration = 0;
+
+    quint16 membershipInterfaceId(const QString& ifaceName)
+    {
+        const auto it = membershipInterfaceIds.constFind(ifaceName);
+        if(it != membershipInterfaceIds.constEnd())
+            return *it;
+
+        const auto id = quint16(membershipInterfaces.size());
+        membershipInterfaceIds.insert(ifaceName, id);
+        membershipInterfaces.push_back({ifaceName, 0, 0});
+        return id;
+    }
+
+    WorkerMembership membership(const QString& group, const QString& ifaceName)
+    {
+        return {QHostAddress(group).toIPv6Address(), membershipInterfaceId(ifaceName)};
+    }
+
+    void addFailedMembership(const WorkerMembership& membership, const QString& group)
+    {
+        if(failedMemberships.emplace(membership, group).second)
+            ++membershipInterfaces[membership.iface].failed;
+    }
+
+    void removeFailedMembership(const WorkerMembership& membership)
+    {
+        if(failedMemberships.erase(membership))
+            --membershipInterfaces[membership.iface].failed;
+    }
+
+    void removeFailedMemberships(quint16 iface)
+    {
+        if(!membershipInterfaces[iface].failed)
+            return;
+
+        for(auto it = failedMemberships.begin(); it != failedMemberships.end();)
+        {
+            if(it->first.iface == iface)
+                it = failedMemberships.erase(it);
+            else
+                ++it;
+        }
+        membershipInterfaces[iface].failed = 0;
+    }
+
+    // Groups joined on 'iface'
+    std::vector<QString> joinedGroups(quint16 iface) const
+    {
+        std::vector<QString> groups;
+        if(!membershipInterfaces[iface].joined)
+            return groups;
+
+        groups.reserve(membershipInterfaces[iface].joined);
+        for(const auto& [membership, state]: memberships)
+        {
+            if(membership.iface == iface)
+                groups.push_back(state.group);
+        }
+        return groups;
+    }
+
+    // Forget every membership, joined or not
+    void clearMemberships()
+    {
+        memberships.clear();
+        failedMemberships.clear();
+        membershipInterfaces.clear();
+        membershipInterfaceIds.clear();
+        listeningInterfacesGeneration = 0;
+    }
+
+    QHostAddress rxHostAddress() const
+    {
+        return rxAddress.isEmpty() ? QHostAddress(QHostAddress::AnyIPv4) : QHostAddress(rxAddress);
+    }
 
     // ─── Multicast - Output ───
 
@@ -78,12 +412,16 @@ struct WorkerPrivate
     // See 'startOutputMulticastInterfaceWatcher'
     MulticastInterfaceList failedToInstantiateMulticastTxSockets;
 
-    // Create a socket for each iface on which we want to multicast
+    // Borrow a socket for each iface on which we want to multicast
     // This is way more efficient than changing IP_MULTICAST_IF at each packet send.
-    // socket won't be used for multicast packet sending
-    // Port used for each socket will be the one specified by txPort
+    // Sockets are shared with every worker that use the same iface, ttl and loopback, see MulticastTxSocketPool.
     InterfaceToMulticastSocket multicastTxSockets;
 
+    quint8 multicastTxTtl() const
+    {
+        return multicastTtl ? multicastTtl : 8;
+    }
+
     // Indicate if multicastSockets are created or not.
     // !_p->multicastSockets.empty() can't be used since it's possible that they is no iface at all.
     // In that case the regular socket should be used to send datagram.
@@ -92,6 +430,35 @@ struct WorkerPrivate
     // If no multicast datagram are send for 30s, then all sockets are destroyed.²
     bool multicastTxSocketsInstantiated = false;
 
+    // ─── Multicast - Egress ───
+
+    MulticastEgressPolicy multicastEgressPolicy = MulticastEgressPolicy::AllInterfaces;
+
+    // Ifaces explicitly used to send to a group, whatever the policy
+    std::map<QString, MulticastInterfaceList> multicastEgressInterfaces;
+
+    // Os index of the iface of the route to each group, 0 when there is no route.
+    // Cleared at each output watcher check, so route changes are seen without a netlink request per datagram.
+    std::map<QString, int> multicastRoutes;
+
+    // Ifaces on which the last write failed, skipped by MulticastEgressPolicy::FirstHealthy until the next output watcher check
+    MulticastInterfaceList unhealthyMulticastTxInterfaces;
+
+    int multicastRouteInterfaceIndex(const QString& group, const QHostAddress& host)
+    {
+        const auto it = multicastRoutes.find(group);
+        if(it != multicastRoutes.end())
+            return it->second;
+
+        QString error;
+        const auto index = NativeSocket::routeInterfaceIndex(host, &error);
+        if(!error.isEmpty())
+            qCDebug(netudp_worker_log) << "Fail to get route to " << group << ", send on every interface : " << error;
+
+        multicastRoutes.insert({group, index});
+        return index;
+    }
+
     bool multicastLoopback = false;
     quint8 multicastTtl = 0;
     bool inputEnabled = false;
@@ -102,17 +469,107 @@ struct WorkerPrivate
         return inputEnabled && rxPort != 0;
     }
 
+    bool useTwoSockets() const
+    {
+        return (separateRxTxSockets || txPort) && inputEnabled;
+    }
+
+    // ──────── RECONFIGURATION ────────
+    // Attributes the unicast and rx sockets are opened with. Changing any other attribute doesn't require new sockets.
+    struct SocketsConfiguration
+    {
+        QString rxAddress;
+        quint16 rxPort = 0;
+        bool inputEnabled = false;
+        bool twoSockets = false;
+        bool strictFiltering = false;
+        bool groupSockets = false;
+
+        bool operator==(const SocketsConfiguration& other) const
+        {
+            return rxAddress == other.rxAddress && rxPort == other.rxPort && inputEnabled == other.inputEnabled
+                   && twoSockets == other.twoSockets && strictFiltering == other.strictFiltering && groupSockets == other.groupSockets;
+        }
+    };
+
+    SocketsConfiguration socketsConfiguration() const
+    {
+        SocketsConfiguration configuration;
+        configuration.inputEnabled = inputEnabled;
+        configuration.twoSockets = useTwoSockets();
+        // Rx attributes are meaningless while nothing is bound
+        if(validInputConfiguration())
+        {
+            configuration.rxAddress = rxAddress;
+            configuration.rxPort = rxPort;
+            configuration.strictFiltering = multicastStrictFiltering;
+            configuration.groupSockets = multicastGroupSockets;
+        }
+        return configuration;
+    }
+
+    // Configuration of the opened sockets, compared at each reconfiguration
+    SocketsConfiguration openedSocketsConfiguration;
+
+    // Nesting of beginReconfiguration/endReconfiguration, changes are applied when it get back to 0
+    int reconfigurationDepth = 0;
+    bool reconfigurationPending = false;
+
+    // ──────── WATCHDOG ────────
+    // Delay before the first restart of a component, doubled at each consecutive failure up to 'watchdogTimeout'
+    static constexpr quint64 watchdogInitialDelay = 10;
+
+    // Restart state of a component, kept across restarts to compute the backoff.
+    // The 'watchdog' timer is used for WatchdogComponent::Worker.
+    struct Recovery
+    {
+        quint32 attempts = 0;
+        QElapsedTimer lastRestart;
+        QTimer* timer = nullptr;
+        QString reason;
+    };
+    // Component, iface name and group. Iface and group are empty for the components that don't need them
+    using RecoveryKey = std::tuple<WatchdogComponent, QString, QString>;
+    std::map<RecoveryKey, Recovery> recoveries;
+
+    // Multicast tx ifaces on which the last write failed or was short, see 'writeMulticastDatagram'
+    std::vector<QString> failedMulticastTxInterfaces;
+
+    // Delay before the next restart of 'key'
+    quint64 recoveryDelay(const RecoveryKey& key)
+    {
+        auto& recovery = recoveries[key];
+
+        // Failed again long after the last restart, that one worked
+        if(recovery.lastRestart.isValid() && recovery.lastRestart.elapsed() > qint64(watchdogTimeout))
+            recovery.attempts = 0;
+
+        const auto shift = std::min<quint32>(recovery.attempts, 32);
+        const auto delay = std::max<quint64>(std::min<quint64>(watchdogInitialDelay << shift, watchdogTimeout), 1);
+
+        // Jitter in [delay / 2, delay], so sockets failing together don't restart together
+        return delay - QRandomGenerator::global()->bounded(quint32(std::min<quint64>(delay / 2, std::numeric_limits<qint32>::max())) + 1);
+    }
+
     // ──────── MULTICAST INTERFACE JOIN WATCHER ────────
-    // Created when at least one iface is being joined. ie (!_p->joinedMulticastGroups.empty() || !_p->failedJoiningMulticastGroup.empty())
-    // Destroy in 'onStop', when joinedMulticastGroups & failedJoiningMulticastGroup are both empty
+    // Created when at least one iface is being joined. ie (!_p->memberships.empty() || !_p->failedMemberships.empty())
+    // Destroy in 'onStop', when memberships & failedMemberships are both empty
     QTimer* listeningMulticastInterfaceWatcher = nullptr;
 
     void startListeningMulticastInterfaceWatcher();
     void stopListeningMulticastInterfaceWatcher();
 
     // ──────── MULTICAST TX JOIN WATCHER ────────
-    // Created when
+    // Driven by the timer shared by every worker in MulticastTxSocketPool.
+    // Own timer only when there is no QCoreApplication to host the pool.
+    // The reference keep the pool alive until the watcher stop, even if the QCoreApplication is destroyed in the meantime.
+    std::shared_ptr<MulticastTxSocketPool> outputMulticastInterfaceWatcherPool;
     QTimer* outputMulticastInterfaceWatcher = nullptr;
+
+    bool outputMulticastInterfaceWatcherRunning() const
+    {
+        return outputMulticastInterfaceWatcherPool || outputMulticastInterfaceWatcher;
+    }
     QElapsedTimer txMulticastPacketElapsedTime;
 
     quint64 rxBytesCounter = 0;
@@ -120,6 +577,9 @@ struct WorkerPrivate
     quint64 rxPacketsCounter = 0;
     quint64 txPacketsCounter = 0;
     quint64 rxInvalidPacket = 0;
+    quint64 rxBudgetDropped = 0;
+    quint64 txMulticastPackets = 0;
+    quint64 txMulticastWrites = 0;
     QTimer* bytesCounterTimer = nullptr;
 };
 
@@ -127,9 +587,19 @@ Worker::Worker(QObject* parent)
     : QObject(parent)
     , _p(std::make_unique<WorkerPrivate>())
 {
+    if(auto* const monitor = InterfacesMonitor::instance())
+    {
+        connect(monitor, &InterfacesMonitor::interfacesChanged, this, &Worker::onInterfacesChanged);
+        connect(monitor, &InterfacesMonitor::activeChanged, this, &Worker::onInterfacesMonitorActiveChanged);
+    }
 }
 
-Worker::~Worker() = default;
+Worker::~Worker()
+{
+    // Sockets borrowed from the pool outlive the worker, even if 'onStop' wasn't called
+    releaseMulticastTxSockets();
+    stopOutputMulticastInterfaceWatcher();
+}
 
 bool Worker::isBounded() const
 {
@@ -190,7 +660,23 @@ size_t Worker::cacheSize() const
 
 bool Worker::resizeCache(size_t length)
 {
-    return _p->cache.resize(length);
+    const auto changed = _p->cache.resize(length);
+    if(_p->cachePrewarmCount)
+        _p->cache.prewarm(_p->cachePrewarmCount);
+    return changed;
+}
+
+size_t Worker::cacheSize(DatagramPool::SizeClass sizeClass) const
+{
+    return _p->cache.size(sizeClass);
+}
+
+bool Worker::resizeCache(DatagramPool::SizeClass sizeClass, size_t length)
+{
+    const auto changed = _p->cache.resize(sizeClass, length);
+    if(_p->cachePrewarmCount)
+        _p->cache.prewarm(sizeClass, _p->cachePrewarmCount);
+    return changed;
 }
 
 void Worker::clearCache()
@@ -203,11 +689,99 @@ void Worker::releaseCache()
     _p->cache.release();
 }
 
+DatagramPoolStatistics Worker::cacheStatistics() const
+{
+    return _p->cache.statistics();
+}
+
+DatagramPoolStatistics Worker::cacheStatistics(DatagramPool::SizeClass sizeClass) const
+{
+    return _p->cache.statistics(sizeClass);
+}
+
+std::size_t Worker::cachePrewarmCount() const
+{
+    return _p->cachePrewarmCount;
+}
+
+void Worker::setCachePrewarmCount(std::size_t count)
+{
+    _p->cachePrewarmCount = count;
+}
+
+DatagramPool::HugePages Worker::cacheHugePages() const
+{
+    return _p->cache.hugePages();
+}
+
+void Worker::setCacheHugePages(DatagramPool::HugePages hugePages)
+{
+    _p->cache.setHugePages(hugePages);
+}
+
+const DatagramPoolAdaptivePolicy& Worker::cacheAdaptivePolicy() const
+{
+    return _p->cache.adaptivePolicy();
+}
+
+void Worker::setCacheAdaptivePolicy(const DatagramPoolAdaptivePolicy& policy)
+{
+    _p->cache.setAdaptivePolicy(policy);
+}
+
 std::shared_ptr<Datagram> Worker::makeDatagram(const size_t length)
 {
     return _p->cache.make(length);
 }
 
+bool Worker::multicastStrictFiltering() const
+{
+    return _p->multicastStrictFiltering;
+}
+
+void Worker::setMulticastStrictFiltering(const bool enabled)
+{
+    if(enabled != _p->multicastStrictFiltering)
+    {
+        _p->multicastStrictFiltering = enabled;
+        requestReconfiguration();
+    }
+}
+
+bool Worker::multicastGroupSockets() const
+{
+    return _p->multicastGroupSockets;
+}
+
+void Worker::setMulticastGroupSockets(const bool enabled)
+{
+    if(enabled != _p->multicastGroupSockets)
+    {
+        _p->multicastGroupSockets = enabled;
+        requestReconfiguration();
+    }
+}
+
+quint32 Worker::maxMembershipsPerSocket() const
+{
+    return _p->maxMembershipsPerSocket;
+}
+
+void Worker::setMaxMembershipsPerSocket(const quint32 count)
+{
+    _p->maxMembershipsPerSocket = std::max<quint32>(count, 1);
+}
+
+qreal Worker::rxBudgetWeight() const
+{
+    return _p->rxBudgetWeight;
+}
+
+void Worker::setRxBudgetWeight(const qreal weight)
+{
+    _p->rxBudgetWeight = weight;
+}
+
 void Worker::onRestart()
 {
     onStop();
@@ -222,6 +796,10 @@ void Worker::onStart()
         return;
     }
 
+    // Pay allocations and page faults now, rather than on the first datagrams after a start or a watchdog restart
+    if(_p->cachePrewarmCount)
+        _p->cache.prewarm(_p->cachePrewarmCount);
+
     if(_p->inputEnabled)
     {
         if(!_p->rxAddress.isEmpty())
@@ -249,22 +827,6 @@ void Worker::onStart()
     _p->isBounded = false;
     Q_ASSERT(_p->watchdog == nullptr);
 
-    _p->failedJoiningMulticastGroup.clear();
-    _p->joinedMulticastGroups.clear();
-    _p->allMulticastInterfaces.clear();
-
-    // Create the socket (and a second one for rx if required)
-    if(_p->socket)
-        _p->socket->deleteLater();
-    _p->socket = new QUdpSocket(this);
-    const bool useTwoSockets = (_p->separateRxTxSockets || _p->txPort) && _p->inputEnabled;
-    if(useTwoSockets)
-    {
-        if(_p->rxSocket)
-            _p->rxSocket->deleteLater();
-        _p->rxSocket = new QUdpSocket(this);
-    }
-
     connect(
         this,
         &Worker::queueStartWatchdog,
@@ -289,13 +851,15 @@ void Worker::onStart()
                     [this]()
                     {
                         qCDebug(netudp_worker_log) << "Watchdog timeout, try to restart socket";
-                        onRestart();
+                        recover(WatchdogComponent::Worker, {}, {});
                     },
                     Qt::ConnectionType::QueuedConnection);
 
-                qCDebug(netudp_worker_log) << "Start watchdog to restart socket in " << watchdogTimeout() << " ms";
+                const auto delay = _p->recoveryDelay({WatchdogComponent::Worker, {}, {}});
+                qCDebug(netudp_worker_log) << "Start watchdog to restart socket in " << delay << " ms";
                 // Start the watchdog
-                _p->watchdog->start(watchdogTimeout());
+                _p->watchdog->setSingleShot(true);
+                _p->watchdog->start(int(delay));
             }
             else
             {
@@ -304,6 +868,28 @@ void Worker::onStart()
         },
         Qt::QueuedConnection);
 
+    if(openSockets())
+        startBytesCounter();
+    else
+        startWatchdog(QStringLiteral("Fail to bind"));
+}
+
+bool Worker::openSockets()
+{
+    Q_ASSERT(_p->socket == nullptr);
+    Q_ASSERT(_p->rxSocket == nullptr);
+
+    _p->openedSocketsConfiguration = _p->socketsConfiguration();
+
+    _p->clearMemberships();
+    _p->allMulticastInterfaces.clear();
+
+    // Create the socket (and a second one for rx if required)
+    _p->socket = new QUdpSocket(this);
+    const bool useTwoSockets = _p->useTwoSockets();
+    if(useTwoSockets)
+        _p->rxSocket = new QUdpSocket(this);
+
     // Connect to socket signals
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
     connect(_p->socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error), this, &Worker::onSocketError);
@@ -350,9 +936,7 @@ void Worker::onStart()
         {
             qCDebug(netudp_worker_log) << "Bind to " << _p->rxAddress << ":" << _p->rxPort;
 
-            const auto hostAddress = _p->rxAddress.isEmpty() ? QHostAddress(QHostAddress::AnyIPv4) : QHostAddress(_p->rxAddress);
-
-            return socket->bind(hostAddress, _p->rxPort, QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint);
+            return socket->bind(_p->rxHostAddress(), _p->rxPort, QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint);
         }
 
         qCDebug(netudp_worker_log) << "No need to bind to any address";
@@ -367,7 +951,8 @@ void Worker::onStart()
     {
         // Sorry for this atrocity, but this is how the library public API is designed
         // Library is in maintenance mode, this highlight bad design and library should be reworked
-        if(!_p->validInputConfiguration())
+        // A reconfiguration to output only keep the socket bounded
+        if(!_p->validInputConfiguration() && !_p->isBounded)
         {
             _p->isBounded = true;
             Q_EMIT isBoundedChanged(true);
@@ -376,6 +961,9 @@ void Worker::onStart()
         if(bindSuccess)
         {
             qCDebug(netudp_worker_log) << "Success bind to " << _p->socket->localAddress() << ":" << _p->socket->localPort();
+
+            if(_p->strictMulticastFiltering() && !workerDisableMulticastAll(rxSocket()->socketDescriptor()))
+                qCWarning(netudp_worker_log) << "Fail to disable IP_MULTICAST_ALL, groups joined by other sockets are also received";
         }
 
         if(!_p->multicastGroups.empty() && rxSocket() && _p->validInputConfiguration())
@@ -387,29 +975,111 @@ void Worker::onStart()
             }
             else
             {
+                const auto snapshot = InterfacesProvider::snapshot();
                 for(const auto& ifaceName: _p->incomingMulticastInterfaces)
                 {
                     for(const auto& group: _p->multicastGroups)
-                        joinAndTrackMulticastGroup(group, ifaceName);
+                        joinAndTrackMulticastGroup(group, ifaceName, *snapshot);
                 }
             }
         }
 
         setMulticastLoopbackToSocket();
-        startBytesCounter();
+        return true;
     }
-    else
+
+    qCWarning(netudp_worker_log) << "Fail to bind to " << (_p->rxAddress.isEmpty() ? "Any" : _p->rxAddress) << ":"
+                                 << _p->socket->localPort();
+    return false;
+}
+
+void Worker::beginReconfiguration()
+{
+    ++_p->reconfigurationDepth;
+}
+
+void Worker::endReconfiguration()
+{
+    if(!_p->reconfigurationDepth)
     {
-        qCWarning(netudp_worker_log) << "Fail to bind to " << (_p->rxAddress.isEmpty() ? "Any" : _p->rxAddress) << ":"
-                                     << _p->socket->localPort();
-        startWatchdog();
+        qCWarning(netudp_worker_log) << "endReconfiguration called without beginReconfiguration";
+        return;
     }
+
+    if(!--_p->reconfigurationDepth && _p->reconfigurationPending)
+        reconfigure();
+}
+
+void Worker::requestReconfiguration()
+{
+    _p->reconfigurationPending = true;
+    if(!_p->reconfigurationDepth)
+        reconfigure();
+}
+
+void Worker::reconfigure()
+{
+    _p->reconfigurationPending = false;
+
+    // Not started, 'onStart' will use the new configuration
+    if(!_p->socket && !_p->watchdog)
+        return;
+
+    // Waiting for the watchdog, the new configuration might be the fix
+    if(!_p->socket)
+    {
+        onRestart();
+        return;
+    }
+
+    if(_p->socketsConfiguration() == _p->openedSocketsConfiguration)
+        return;
+
+    qCDebug(netudp_worker_log) << "Reconfigure sockets, previous sockets are closed once the new ones are bound";
+
+    if(!reopenSockets())
+        startWatchdog(QStringLiteral("Fail to bind after a reconfiguration"));
+}
+
+bool Worker::reopenSockets()
+{
+    // Make before break: previous sockets keep their memberships at os level until the new sockets joined the same groups,
+    // so the host never leave a group. Multicast tx sockets, counters and caches are untouched.
+    auto* const previousSocket = std::exchange(_p->socket, nullptr);
+    auto* const previousRxSocket = std::exchange(_p->rxSocket, nullptr);
+    auto previousShards = std::move(_p->membershipShards);
+    _p->membershipShards.clear();
+    _p->clearMemberships();
+    stopListeningMulticastInterfaceWatcher();
+
+    const bool success = openSockets();
+
+    const auto closePreviousSocket = [this, success](QUdpSocket* socket)
+    {
+        if(!socket)
+            return;
+
+        // Deliver what was received before the new sockets were bound
+        if(success)
+            readSocketDatagrams(socket);
+        disconnect(socket, nullptr, this, nullptr);
+        socket->deleteLater();
+    };
+
+    // First shard is the previous rx socket
+    for(std::size_t i = 1; i < previousShards.size(); ++i)
+        closePreviousSocket(previousShards[i].socket);
+    closePreviousSocket(previousRxSocket);
+    closePreviousSocket(previousSocket);
+
+    return success;
 }
 
 void Worker::onStop()
 {
     // Important watchdog can be valid while socket is not !!
     stopWatchdog();
+    cancelRecoveries();
 
     if(!_p->socket)
     {
@@ -424,6 +1094,7 @@ void Worker::onStop()
     stopListeningMulticastInterfaceWatcher();
     stopOutputMulticastInterfaceWatcher();
     stopBytesCounter();
+    destroyMembershipShards();
     disconnect(this, nullptr, this, nullptr);
 
     if(_p->socket)
@@ -442,18 +1113,23 @@ void Worker::onStop()
     _p->rxSocket = nullptr;
     _p->multicastTtl = 0;
 
-    // Delete every multicast outgoing socket
-    for(const auto& [iface, socket]: _p->multicastTxSockets)
-        socket->deleteLater();
-    _p->multicastTxSockets.clear();
+    // Give back every multicast outgoing socket
+    releaseMulticastTxSockets();
 
-    _p->failedJoiningMulticastGroup.clear();
-    _p->joinedMulticastGroups.clear();
+    _p->clearMemberships();
     _p->allMulticastInterfaces.clear();
     _p->failedToInstantiateMulticastTxSockets.clear();
     _p->multicastTxSocketsInstantiated = false;
 }
 
+void Worker::onStopRequested()
+{
+    onStop();
+    // Next start begin without backoff
+    _p->recoveries.clear();
+    Q_EMIT stopped();
+}
+
 void Worker::initialize(quint64 watchdog,
     QString rxAddress,
     quint16 rxPort,
@@ -488,7 +1164,7 @@ void Worker::setAddress(const QString& address)
     if(address != _p->rxAddress)
     {
         _p->rxAddress = address;
-        onRestart();
+        requestReconfiguration();
     }
 }
 
@@ -497,8 +1173,7 @@ void Worker::setRxPort(const quint16 port)
     if(port != _p->rxPort)
     {
         _p->rxPort = port;
-        if(_p->inputEnabled)
-            onRestart();
+        requestReconfiguration();
     }
 }
 
@@ -507,7 +1182,7 @@ void Worker::setInputEnabled(const bool enabled)
     if(enabled != _p->inputEnabled)
     {
         _p->inputEnabled = enabled;
-        onRestart();
+        requestReconfiguration();
     }
 }
 
@@ -516,7 +1191,7 @@ void Worker::setTxPort(const quint16 port)
     if(port != _p->txPort)
     {
         _p->txPort = port;
-        onRestart();
+        requestReconfiguration();
     }
 }
 
@@ -538,25 +1213,16 @@ void Worker::joinMulticastGroup(const QString& address)
     if(!rxSocket())
         return;
 
-    if(_p->incomingMulticastInterfaces.empty())
-    {
-        if(_p->allMulticastInterfaces.empty())
-        {
-            tryJoinAllAvailableInterfaces();
-        }
-        else
-        {
-            // Join the group address an each iface an keep track of success or fail
-            for(const auto& ifaceName: _p->allMulticastInterfaces)
-                joinAndTrackMulticastGroup(address, ifaceName);
-        }
-    }
-    else
+    if(_p->incomingMulticastInterfaces.empty() && _p->allMulticastInterfaces.empty())
     {
-        // Join the group address an each iface an keep track of success or fail
-        for(const auto& ifaceName: _p->incomingMulticastInterfaces)
-            joinAndTrackMulticastGroup(address, ifaceName);
+        tryJoinAllAvailableInterfaces();
+        return;
     }
+
+    // Join the group address an each iface an keep track of success or fail
+    const auto snapshot = InterfacesProvider::snapshot();
+    for(const auto& ifaceName: _p->currentMulticastInterfaces())
+        joinAndTrackMulticastGroup(address, ifaceName, *snapshot);
 }
 
 void Worker::leaveMulticastGroup(const QString& address)
@@ -570,57 +1236,115 @@ void Worker::leaveMulticastGroup(const QString& address)
         return;
 
     _p->multicastGroups.erase(it);
+    // Memberships keep the filter they were joined with
+    _p->multicastSourceFilters.erase(address);
 
     // No rx socket mean that the socket isn't started. It mean that no multicast group are also joined
     if(!rxSocket())
         return;
 
-    std::vector<QString> ifaceNameJoinedToRemove;
-    std::vector<QString> ifaceNameFailedToRemove;
+    leaveAndUntrackMulticastGroup(address, *InterfacesProvider::snapshot());
 
-    // Leave the multicast group on every iface that were joined successfully
-    for(auto& [ifaceName, groups]: _p->joinedMulticastGroups)
-    {
-        // Really leave if the address was erased(ie found) in the set.
-        if(groups.erase(address))
-            socketLeaveMulticastGroup(address, ifaceName);
+    if(_p->multicastGroups.empty())
+        stopListeningMulticastInterfaceWatcher();
+}
 
-        if(groups.empty())
-            ifaceNameJoinedToRemove.push_back(ifaceName);
+void Worker::updateMulticastGroups(const QStringList& joined, const QStringList& left)
+{
+    qCDebug(netudp_worker_log) << "Update Multicast groups, join " << joined.size() << ", leave " << left.size();
+
+    std::set<QString> leftGroups;
+    for(const auto& address: left)
+    {
+        if(_p->multicastGroups.erase(address))
+            leftGroups.insert(address);
+        _p->multicastSourceFilters.erase(address);
     }
 
-    // And also clean _p->failedJoiningMulticastGroup from the multicast group we are leaving
-    for(auto& [ifaceName, groups]: _p->failedJoiningMulticastGroup)
+    std::vector<QString> joinedGroups;
+    joinedGroups.reserve(joined.size());
+    for(const auto& address: joined)
     {
-        groups.erase(address);
+        if(_p->multicastGroups.insert(address).second)
+            joinedGroups.push_back(address);
+    }
 
-        if(groups.empty())
-            ifaceNameFailedToRemove.push_back(ifaceName);
+    // No rx socket mean that the socket isn't started. 'onStart' will take care of really joining the groups.
+    if(!rxSocket())
+        return;
+
+    // Leave first, so memberships are released before new groups are joined.
+    // Groups kept between the two lists are not touched and keep receiving.
+    const auto snapshot = InterfacesProvider::snapshot();
+    for(const auto& address: leftGroups)
+        leaveAndUntrackMulticastGroup(address, *snapshot);
+
+    if(_p->multicastGroups.empty())
+    {
+        stopListeningMulticastInterfaceWatcher();
+        return;
     }
 
-    // Remove ifaces from that that have an empty key
-    if(ifaceNameJoinedToRemove.size() == _p->joinedMulticastGroups.size())
+    // Input disable, we should listen to anything nor subscribe
+    if(joinedGroups.empty() || !_p->inputEnabled)
+        return;
+
+    if(_p->incomingMulticastInterfaces.empty() && _p->allMulticastInterfaces.empty())
     {
-        _p->joinedMulticastGroups.clear();
+        tryJoinAllAvailableInterfaces();
+        return;
     }
-    else
+
+    for(const auto& ifaceName: _p->currentMulticastInterfaces())
     {
-        for(const auto& name: ifaceNameJoinedToRemove)
-            _p->joinedMulticastGroups.erase(name);
+        for(const auto& address: joinedGroups)
+            joinAndTrackMulticastGroup(address, ifaceName, *snapshot);
     }
+}
 
-    if(ifaceNameFailedToRemove.size() == _p->failedJoiningMulticastGroup.size())
+void Worker::setMulticastSourceFilter(const QString& address, const bool exclude, const QStringList& sources)
+{
+    qCDebug(netudp_worker_log) << "Set source filter of multicast group " << address << (exclude ? " exclude " : " include ") << sources;
+
+    WorkerSourceFilterPtr filter;
+    if(!sources.isEmpty())
     {
-        _p->failedJoiningMulticastGroup.clear();
+        auto newFilter = std::make_shared<WorkerSourceFilter>();
+        newFilter->exclude = exclude;
+        for(const auto& source: sources)
+        {
+            const QHostAddress sourceAddress(source);
+            if(!sourceAddress.isNull())
+                newFilter->sources.push_back(sourceAddress);
+        }
+        filter = std::move(newFilter);
     }
+
+    if(filter)
+        _p->multicastSourceFilters[address] = std::move(filter);
     else
+        _p->multicastSourceFilters.erase(address);
+
+    // Not joined yet, the filter will be applied by 'joinAndTrackMulticastGroup'
+    if(!rxSocket() || !_p->multicastGroups.count(address))
+        return;
+
+    // Update the filter on every iface. Ifaces that fail are restarted by the watchdog, or by the listening watcher.
+    const auto snapshot = InterfacesProvider::snapshot();
+    const auto group = QHostAddress(address).toIPv6Address();
+    for(std::size_t i = 0; i < _p->membershipInterfaces.size(); ++i)
     {
-        for(const auto& name: ifaceNameFailedToRemove)
-            _p->failedJoiningMulticastGroup.erase(name);
-    }
+        const WorkerMembership membership {group, quint16(i)};
+        if(!_p->memberships.count(membership))
+            continue;
 
-    if(_p->multicastGroups.empty())
-        stopListeningMulticastInterfaceWatcher();
+        const auto ifaceName = _p->membershipInterfaces[i].name;
+        if(!socketUpdateMulticastSourceFilter(address, ifaceName, *snapshot))
+        {
+            _p->addFailedMembership(membership, address);
+            scheduleMembershipRecovery(address, ifaceName, *snapshot);
+        }
+    }
 }
 
 void Worker::joinMulticastInterface(const QString& ifaceName)
@@ -629,7 +1353,6 @@ void Worker::joinMulticastInterface(const QString& ifaceName)
         tryLeaveAllAvailableInterfaces();
 
     const auto [ifaceNameIt, ifaceNameInsertSuccess] = _p->incomingMulticastInterfaces.insert(ifaceName);
-    const auto iface = InterfacesProvider::interfaceFromName(ifaceName);
 
     // Interface already exist. We don't need to do any actions
     if(!ifaceNameInsertSuccess)
@@ -644,8 +1367,9 @@ void Worker::joinMulticastInterface(const QString& ifaceName)
         return;
 
     // Join each multicast group
+    const auto snapshot = InterfacesProvider::snapshot();
     for(const auto& group: _p->multicastGroups)
-        joinAndTrackMulticastGroup(group, ifaceName);
+        joinAndTrackMulticastGroup(group, ifaceName, *snapshot);
 }
 
 void Worker::leaveMulticastInterface(const QString& ifaceName)
@@ -658,19 +1382,9 @@ void Worker::leaveMulticastInterface(const QString& ifaceName)
     if(!rxSocket())
         return;
 
-    // Leave all group join on iface 'ifaceName'
-    const auto it = _p->joinedMulticastGroups.find(ifaceName);
-    if(it != _p->joinedMulticastGroups.end())
-    {
-        const auto& groupJoined = it->second;
-        for(const auto& group: groupJoined)
-            socketLeaveMulticastGroup(group, ifaceName);
-
-        _p->joinedMulticastGroups.erase(it);
-    }
-
-    // Clear cache of failed to join multicast group
-    _p->failedJoiningMulticastGroup.erase(ifaceName);
+    // Leave all group join on iface 'ifaceName', and forget the ones that failed
+    leaveAndUntrackMulticastInterface(ifaceName, *InterfacesProvider::snapshot());
+    cancelRecoveries(WatchdogComponent::MulticastMembership, ifaceName);
 
     // Try to listen on every ifaces if _p->incomingMulticastInterfaces is empty
     if(_p->incomingMulticastInterfaces.empty())
@@ -687,6 +1401,13 @@ void Worker::setMulticastLoopback(const bool loopback)
     {
         _p->multicastLoopback = loopback;
         setMulticastLoopbackToSocket();
+
+        // Loopback ifaces might be joined, or not anymore
+        _p->listeningInterfacesGeneration = 0;
+
+        // Loopback is part of the pool key, sockets are borrowed again at next send
+        if(_p->multicastTxSocketsInstantiated)
+            destroyMulticastOutputSockets();
     }
 }
 
@@ -703,19 +1424,50 @@ void Worker::setMulticastOutgoingInterfaces(const QStringList& ifaces)
     // Copy ifaces to _p->outgoingMulticastInterfaces
     _p->outgoingMulticastInterfaces = WorkerPrivate::MulticastInterfaceList(ifaces.begin(), ifaces.end());
 
+    // Pending restarts of ifaces that aren't selected anymore would create their socket again
+    if(!_p->outgoingMulticastInterfaces.empty())
+    {
+        std::vector<QString> deselectedInterfaces;
+        for(const auto& [key, recovery]: _p->recoveries)
+        {
+            const auto& ifaceName = std::get<1>(key);
+            if(std::get<0>(key) == WatchdogComponent::MulticastTxSocket && !_p->outgoingMulticastInterfaces.count(ifaceName))
+                deselectedInterfaces.push_back(ifaceName);
+        }
+        for(const auto& ifaceName: deselectedInterfaces)
+            cancelRecoveries(WatchdogComponent::MulticastTxSocket, ifaceName);
+    }
+
     // Destroy what was already instantiated.
     if(_p->multicastTxSocketsInstantiated)
         destroyMulticastOutputSockets();
 }
 
+MulticastEgressPolicy Worker::multicastEgressPolicy() const
+{
+    return _p->multicastEgressPolicy;
+}
+
+void Worker::setMulticastEgressPolicy(const netudp::MulticastEgressPolicy policy)
+{
+    _p->multicastEgressPolicy = policy;
+}
+
+void Worker::setMulticastEgressInterfaces(const QString& address, const QStringList& interfaces)
+{
+    if(interfaces.empty())
+        _p->multicastEgressInterfaces.erase(address);
+    else
+        _p->multicastEgressInterfaces[address] = WorkerPrivate::MulticastInterfaceList(interfaces.begin(), interfaces.end());
+}
+
 void Worker::setSeparateRxTxSockets(const bool separateRxTxSocketsChanged)
 {
     const bool shouldUseSeparate = separateRxTxSocketsChanged || _p->txPort;
     if(shouldUseSeparate != _p->separateRxTxSockets)
     {
         _p->separateRxTxSockets = shouldUseSeparate;
-        if(_p->inputEnabled)
-            onRestart();
+        requestReconfiguration();
     }
 }
 
@@ -733,13 +1485,13 @@ void Worker::tryJoinAllAvailableInterfaces()
         return;
 
     // Assert that model is really empty
-    Q_ASSERT(_p->joinedMulticastGroups.empty());
-    Q_ASSERT(_p->failedJoiningMulticastGroup.empty());
+    Q_ASSERT(_p->memberships.empty());
+    Q_ASSERT(_p->failedMemberships.empty());
 
     // join every group on every iface
     // It is expected for ifaces to fail joining. Attempt to join will be made later.
-    const auto& allInterfaces = InterfacesProvider::allInterfaces();
-    for(const auto& iface: allInterfaces)
+    const auto snapshot = InterfacesProvider::snapshot();
+    for(const auto& iface: *snapshot)
     {
         Q_ASSERT(iface);
         if(const auto [it, success] = _p->allMulticastInterfaces.insert(iface->name()); !success)
@@ -747,7 +1499,7 @@ void Worker::tryJoinAllAvailableInterfaces()
 
         for(const auto& group: _p->multicastGroups)
         {
-            joinAndTrackMulticastGroup(group, iface->name());
+            joinAndTrackMulticastGroup(group, iface->name(), *snapshot);
         }
     }
 }
@@ -761,44 +1513,64 @@ void Worker::tryLeaveAllAvailableInterfaces()
     if(!rxSocket())
         return;
 
-    for(const auto& [ifaceName, groups]: _p->joinedMulticastGroups)
+    const auto snapshot = InterfacesProvider::snapshot();
+    for(std::size_t i = 0; i < _p->membershipInterfaces.size(); ++i)
     {
-        for(const auto& group: groups)
-            socketLeaveMulticastGroup(group, ifaceName);
+        const auto ifaceName = _p->membershipInterfaces[i].name;
+        for(const auto& group: _p->joinedGroups(quint16(i)))
+            socketLeaveMulticastGroup(group, ifaceName, *snapshot);
     }
 
-    _p->joinedMulticastGroups.clear();
-    _p->failedJoiningMulticastGroup.clear();
+    _p->clearMemberships();
     _p->allMulticastInterfaces.clear();
     stopListeningMulticastInterfaceWatcher();
 }
 
-bool Worker::joinAndTrackMulticastGroup(const QString& address, const QString& ifaceName)
+bool Worker::joinAndTrackMulticastGroup(const QString& address, const QString& ifaceName, const InterfacesSnapshot& snapshot)
 {
     // Create a timer anyway, we have at least one iface to watch
     startListeningMulticastInterfaceWatcher();
 
-    if(!socketJoinMulticastGroup(address, ifaceName))
+    const auto membership = _p->membership(address, ifaceName);
+    if(!socketJoinMulticastGroup(address, ifaceName, snapshot))
     {
-        _p->failedJoiningMulticastGroup[ifaceName].insert(address);
+        _p->addFailedMembership(membership, address);
+        scheduleMembershipRecovery(address, ifaceName, snapshot);
         return false;
     }
 
-    const auto [insertedIt, groupInserted] = _p->joinedMulticastGroups[ifaceName].insert(address);
-
-    // If assert here it mean something gone wrong in join/leave.
-    Q_ASSERT(groupInserted);
+    _p->removeFailedMembership(membership);
     return true;
 }
 
-bool Worker::socketJoinMulticastGroup(const QString& address, const QString& ifaceName)
+void Worker::leaveAndUntrackMulticastGroup(const QString& address, const InterfacesSnapshot& snapshot)
+{
+    // Ifaces are few, looking up each one avoid walking every membership
+    const auto group = QHostAddress(address).toIPv6Address();
+    for(std::size_t i = 0; i < _p->membershipInterfaces.size(); ++i)
+    {
+        const WorkerMembership membership {group, quint16(i)};
+        if(_p->membershipInterfaces[i].joined && _p->memberships.count(membership))
+        {
+            const auto ifaceName = _p->membershipInterfaces[i].name;
+            socketLeaveMulticastGroup(address, ifaceName, snapshot);
+        }
+        _p->removeFailedMembership(membership);
+    }
+}
+
+void Worker::leaveAndUntrackMulticastInterface(const QString& ifaceName, const InterfacesSnapshot& snapshot)
+{
+    const auto iface = _p->membershipInterfaceId(ifaceName);
+    for(const auto& group: _p->joinedGroups(iface))
+        socketLeaveMulticastGroup(group, ifaceName, snapshot);
+    _p->removeFailedMemberships(iface);
+}
+
+bool Worker::socketJoinMulticastGroup(const QString& address, const QString& ifaceName, const InterfacesSnapshot& snapshot)
 {
     const QHostAddress hostAddress(address);
-    const auto networkInterface = QNetworkInterface::interfaceFromName(ifaceName);
-    const auto networkInterfaceValid = networkInterface.isValid() && (networkInterface.flags() & QNetworkInterface::IsUp)
-                                       && (networkInterface.flags() & QNetworkInterface::IsRunning)
-                                       && ((networkInterface.flags() & QNetworkInterface::CanMulticast)
-                                           || (multicastLoopback() && (networkInterface.flags() & QNetworkInterface::IsLoopBack)));
+    const auto iface = snapshot.fromName(ifaceName);
 
     // should be verified by Socket
     Q_ASSERT(hostAddress.isMulticast());
@@ -811,45 +1583,90 @@ bool Worker::socketJoinMulticastGroup(const QString& address, const QString& ifa
         return false;
     }
 
-    // Try to join the multicast group
-    if(!networkInterfaceValid || !rxSocket()->joinMulticastGroup(hostAddress, networkInterface))
+    if(!iface)
     {
-        if(networkInterfaceValid)
-        {
-            qCWarning(netudp_worker_log) << "Fail to join multicast group " << address << " on interface " << ifaceName
-                                         << ", error : " << rxSocket()->errorString();
-        }
-        else
-        {
-            qCWarning(netudp_worker_log) << "Fail to join multicast group " << address << " on interface " << ifaceName
-                                         << "because iface is not valid : IsUp:" << bool(networkInterface.flags() & QNetworkInterface::IsUp)
-                                         << ", IsRunning:" << bool(networkInterface.flags() & QNetworkInterface::IsRunning)
-                                         << ", CanMulticast:" << bool(networkInterface.flags() & QNetworkInterface::CanMulticast)
-                                         << ", IsLoopBack:" << bool(networkInterface.flags() & QNetworkInterface::IsLoopBack);
-        }
+        qCWarning(netudp_worker_log) << "Fail to join multicast group " << address << " on interface " << ifaceName
+                                     << "because iface doesn't exist";
+        return false;
+    }
+
+    if(!workerMulticastInterfaceValid(iface.get(), multicastLoopback()))
+    {
+        qCWarning(netudp_worker_log) << "Fail to join multicast group " << address << " on interface " << ifaceName
+                                     << "because iface is not valid : IsUp:" << iface->isUp() << ", IsRunning:" << iface->isRunning()
+                                     << ", CanMulticast:" << iface->canMulticast() << ", IsLoopBack:" << iface->isLoopBack();
+        return false;
+    }
+
+    // Membership kept by the os while the iface was down, forget it before joining again
+    QString error;
+    const auto membership = _p->membership(address, ifaceName);
+    if(_p->memberships.count(membership))
+        leaveMembership(hostAddress, ifaceName, true, error);
+
+    const auto shard = availableMembershipShard(hostAddress);
+    if(shard < 0)
+    {
+        qCWarning(netudp_worker_log) << "Fail to join multicast group " << address << " on interface " << ifaceName
+                                     << ", no rx socket available";
+        return false;
+    }
+
+    // Join by index with a single setsockopt, Qt resolve the iface address again for every IPv4 join.
+    // Dual stack sockets are left to Qt that handle v4 mapped groups, but doesn't support source filters.
+    auto* const socket = _p->membershipShards[shard].socket;
+    const auto filter = _p->multicastSourceFilter(address);
+    const auto ifaceIndex = iface->index();
+    const bool native = ifaceIndex > 0 && socket->localAddress().protocol() == hostAddress.protocol();
+    bool joined = false;
+    if(native)
+    {
+        joined = workerJoinNativeMembership(socket->socketDescriptor(), hostAddress, ifaceIndex, filter.get(), error);
+    }
+    else if(filter)
+    {
+        error = QStringLiteral("source filter require an IPv4 or IPv6 only socket and an interface index");
+    }
+    else
+    {
+        joined = socket->joinMulticastGroup(hostAddress, workerNetworkInterface(ifaceName, ifaceIndex));
+        if(!joined)
+            error = socket->errorString();
+    }
+
+    if(!joined)
+    {
+        qCWarning(netudp_worker_log) << "Fail to join multicast group " << address << " on interface " << ifaceName
+                                     << ", error : " << error;
         return false;
     }
 
-    qCDebug(netudp_worker_log) << "Success Join multicast group " << address << " on iface " << ifaceName;
+    _p->memberships.emplace(membership, WorkerPrivate::MembershipState {quint16(shard), ifaceIndex, native, filter, address});
+    ++_p->membershipInterfaces[membership.iface].joined;
+    ++_p->membershipShards[shard].memberships;
+
+    qCDebug(netudp_worker_log) << "Success Join multicast group " << address << " on iface " << ifaceName << " (rx socket " << shard
+                               << ")";
 
     Q_EMIT multicastGroupJoined(address, ifaceName);
 
     return true;
 }
 
-bool Worker::socketLeaveMulticastGroup(const QString& address, const QString& ifaceName)
+bool Worker::socketLeaveMulticastGroup(const QString& address, const QString& ifaceName, const InterfacesSnapshot& snapshot)
 {
     const QHostAddress hostAddress(address);
-    const auto networkInterface = QNetworkInterface::interfaceFromName(ifaceName);
-    const auto networkInterfaceValid =
-        networkInterface.isValid() && networkInterface.flags() & (QNetworkInterface::IsRunning | QNetworkInterface::IsUp);
+    const auto iface = snapshot.fromName(ifaceName);
+    const auto ifaceValid = iface && iface->isValid() && (iface->isRunning() || iface->isUp());
 
-    if(!networkInterfaceValid || !rxSocket()->leaveMulticastGroup(hostAddress, networkInterface))
+    // The membership is forgotten even if the iface is gone, the os already dropped it.
+    QString error;
+    if(!leaveMembership(hostAddress, ifaceName, ifaceValid, error) || !ifaceValid)
     {
-        if(networkInterfaceValid)
+        if(ifaceValid)
         {
             qCWarning(netudp_worker_log) << "Fail to leave multicast group " << address << "  on interface " << ifaceName
-                                         << ", error : " << rxSocket()->errorString();
+                                         << ", error : " << error;
         }
         else
         {
@@ -866,6 +1683,168 @@ bool Worker::socketLeaveMulticastGroup(const QString& address, const QString& if
     return true;
 }
 
+bool Worker::socketUpdateMulticastSourceFilter(const QString& address, const QString& ifaceName, const InterfacesSnapshot& snapshot)
+{
+    const QHostAddress hostAddress(address);
+    const auto it = _p->memberships.find(_p->membership(address, ifaceName));
+    if(it == _p->memberships.end())
+        return false;
+
+    auto& membership = it->second;
+    auto filter = _p->multicastSourceFilter(address);
+
+    // Memberships joined by Qt don't support source filters, joining again report why
+    if(!membership.native)
+    {
+        socketLeaveMulticastGroup(address, ifaceName, snapshot);
+        return socketJoinMulticastGroup(address, ifaceName, snapshot);
+    }
+
+    const auto descriptor = _p->membershipShards[membership.shard].socket->socketDescriptor();
+    QString error;
+    if(!workerUpdateNativeMembership(descriptor, hostAddress, membership.ifaceIndex, membership.filter.get(), filter.get(), error))
+    {
+        qCWarning(netudp_worker_log) << "Fail to update source filter of multicast group " << address << " on interface " << ifaceName
+                                     << ", error : " << error;
+
+        // The os already dropped the membership
+        leaveMembership(hostAddress, ifaceName, false, error);
+        Q_EMIT multicastGroupLeaved(address, ifaceName);
+        return false;
+    }
+
+    membership.filter = std::move(filter);
+    qCDebug(netudp_worker_log) << "Success update source filter of multicast group " << address << " on interface " << ifaceName;
+    return true;
+}
+
+bool Worker::leaveMembership(const QHostAddress& group, const QString& ifaceName, const bool ifaceValid, QString& error)
+{
+    const auto it = _p->memberships.find({group.toIPv6Address(), _p->membershipInterfaceId(ifaceName)});
+    if(it == _p->memberships.end())
+    {
+        error = QStringLiteral("group isn't joined");
+        return false;
+    }
+
+    --_p->membershipInterfaces[it->first.iface].joined;
+    const auto membership = std::move(it->second);
+    _p->memberships.erase(it);
+
+    auto& shard = _p->membershipShards[membership.shard];
+    Q_ASSERT(shard.memberships);
+    --shard.memberships;
+
+    // A socket bound to the group is of no use anymore, closing it drop its remaining memberships
+    if(!shard.memberships && !shard.group.isNull())
+    {
+        disconnect(shard.socket, nullptr, this, nullptr);
+        shard.socket->deleteLater();
+        shard = {};
+        return true;
+    }
+
+    if(!ifaceValid)
+        return true;
+
+    if(membership.native)
+        return workerLeaveNativeMembership(shard.socket->socketDescriptor(), group, membership.ifaceIndex, membership.filter.get(), error);
+
+    if(shard.socket->leaveMulticastGroup(group, workerNetworkInterface(ifaceName, membership.ifaceIndex)))
+        return true;
+
+    error = shard.socket->errorString();
+    return false;
+}
+
+int Worker::availableMembershipShard(const QHostAddress& group)
+{
+    if(_p->membershipShards.empty())
+        _p->membershipShards.push_back({rxSocket(), 0, {}});
+
+    const auto bindAddress = _p->bindMulticastGroupSockets() ? group : QHostAddress();
+    int freeSlot = -1;
+    for(std::size_t i = 0; i < _p->membershipShards.size(); ++i)
+    {
+        const auto& shard = _p->membershipShards[i];
+        if(!shard.socket)
+        {
+            if(freeSlot < 0)
+                freeSlot = int(i);
+            continue;
+        }
+
+        if(shard.group == bindAddress && shard.memberships < _p->maxMembershipsPerSocket)
+            return int(i);
+    }
+
+    if(freeSlot < 0 && _p->membershipShards.size() > std::numeric_limits<quint16>::max())
+        return -1;
+
+    // Each shard should only receive the groups it joined, otherwise every datagram would be read once per shard.
+    if(_p->membershipShards.size() == 1 && !_p->strictMulticastFiltering()
+        && !workerDisableMulticastAll(_p->membershipShards.front().socket->socketDescriptor()))
+    {
+        qCWarning(netudp_worker_log) << "Fail to disable IP_MULTICAST_ALL on the rx socket, no other rx socket can be created";
+        return -1;
+    }
+
+    auto* const socket = createMembershipSocket(bindAddress.isNull() ? _p->rxHostAddress() : bindAddress);
+    if(!socket)
+        return -1;
+
+    qCDebug(netudp_worker_log) << "Create multicast rx socket bound to " << socket->localAddress() << ":" << socket->localPort();
+
+    if(freeSlot >= 0)
+    {
+        _p->membershipShards[freeSlot] = {socket, 0, bindAddress};
+        return freeSlot;
+    }
+
+    _p->membershipShards.push_back({socket, 0, bindAddress});
+    return int(_p->membershipShards.size() - 1);
+}
+
+QUdpSocket* Worker::createMembershipSocket(const QHostAddress& address)
+{
+    auto* const socket = new QUdpSocket(this);
+    if(!socket->bind(address, _p->rxPort, QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint))
+    {
+        qCWarning(netudp_worker_log) << "Fail to bind an additional multicast rx socket to " << address << ":" << _p->rxPort
+                                     << ", error : " << socket->errorString();
+        socket->deleteLater();
+        return nullptr;
+    }
+
+    // Otherwise datagrams of the groups joined by the other shards would be read twice
+    if(!workerDisableMulticastAll(socket->socketDescriptor()))
+    {
+        qCWarning(netudp_worker_log) << "Fail to disable IP_MULTICAST_ALL on an additional multicast rx socket";
+        socket->deleteLater();
+        return nullptr;
+    }
+
+    socket->setSocketOption(QAbstractSocket::SocketOption::MulticastLoopbackOption, _p->multicastLoopback);
+    connect(socket, &QUdpSocket::readyRead, this, &Worker::readPendingDatagrams);
+    connectSocketErrors(socket);
+    return socket;
+}
+
+void Worker::destroyMembershipShards()
+{
+    // First shard is rxSocket(), destroyed with it
+    for(std::size_t i = 1; i < _p->membershipShards.size(); ++i)
+    {
+        auto* const socket = _p->membershipShards[i].socket;
+        if(!socket)
+            continue;
+        disconnect(socket, nullptr, this, nullptr);
+        socket->deleteLater();
+    }
+    _p->membershipShards.clear();
+    _p->clearMemberships();
+}
+
 void Worker::setMulticastLoopbackToSocket() const
 {
     if(rxSocket() && _p->inputEnabled)
@@ -874,27 +1853,211 @@ void Worker::setMulticastLoopbackToSocket() const
         if(rxSocket() != _p->socket)
             _p->socket->setSocketOption(QAbstractSocket::SocketOption::MulticastLoopbackOption, _p->multicastLoopback);
 
-        for(const auto& [ifaceName, socket]: _p->multicastTxSockets)
+        for(std::size_t i = 1; i < _p->membershipShards.size(); ++i)
+        {
+            if(auto* const socket = _p->membershipShards[i].socket)
+                socket->setSocketOption(QAbstractSocket::SocketOption::MulticastLoopbackOption, _p->multicastLoopback);
+        }
+    }
+}
+
+void Worker::startWatchdog(const QString& reason)
+{
+    qCWarning(netudp_worker_log) << "Restart every socket : " << reason;
+    _p->recoveries[{WatchdogComponent::Worker, {}, {}}].reason = reason;
+    Q_EMIT queueStartWatchdog();
+}
+
+void Worker::stopWatchdog()
+{
+    if(_p->watchdog)
+    {
+        disconnect(_p->watchdog, nullptr, this, nullptr);
+        _p->watchdog->stop();
+        _p->watchdog->deleteLater();
+        _p->watchdog = nullptr;
+    }
+}
+
+void Worker::scheduleRecovery(WatchdogComponent component, const QString& interfaceName, const QString& group, const QString& reason)
+{
+    // Stopped, or every socket is restarted already
+    if(!_p->socket || _p->watchdog)
+        return;
+
+    const WorkerPrivate::RecoveryKey key{component, interfaceName, group};
+    auto& recovery = _p->recoveries[key];
+
+    // The pending restart will fix this failure too
+    if(recovery.timer)
+        return;
+
+    recovery.reason = reason;
+    const auto delay = _p->recoveryDelay(key);
+    qCWarning(netudp_worker_log) << "Restart" << static_cast<int>(component) << interfaceName << group << "in" << delay
+                                 << "ms : " << reason;
+
+    recovery.timer = new QTimer(this);
+    recovery.timer->setSingleShot(true);
+    connect(recovery.timer,
+        &QTimer::timeout,
+        this,
+        [this, component, interfaceName, group]()
+        {
+            recover(component, interfaceName, group);
+        });
+    recovery.timer->start(int(delay));
+}
+
+void Worker::recover(WatchdogComponent component, const QString& interfaceName, const QString& group)
+{
+    auto& recovery = _p->recoveries[{component, interfaceName, group}];
+    if(recovery.timer)
+    {
+        recovery.timer->deleteLater();
+        recovery.timer = nullptr;
+    }
+
+    // The component might have been fixed, or removed, while waiting
+    const auto snapshot = InterfacesProvider::snapshot();
+    const bool obsolete = [&]()
+    {
+        switch(component)
+        {
+        // Ifaces removed from the configuration are obsolete too, an empty list meaning every iface
+        case WatchdogComponent::MulticastTxSocket:
+            if(!_p->outgoingMulticastInterfaces.empty() && !_p->outgoingMulticastInterfaces.count(interfaceName))
+                return true;
+            // An iface that disappeared is left to the output watcher
+            if(!snapshot->fromName(interfaceName))
+                return true;
+            return !_p->multicastTxSocketsInstantiated || _p->multicastTxSockets.count(interfaceName) > 0;
+        case WatchdogComponent::MulticastMembership:
+        {
+            if(!rxSocket() || !_p->multicastGroups.count(group))
+                return true;
+            if(!_p->incomingMulticastInterfaces.empty() && !_p->incomingMulticastInterfaces.count(interfaceName))
+                return true;
+            return _p->memberships.count(_p->membership(group, interfaceName)) > 0;
+        }
+        default:;
+        }
+        return false;
+    }();
+    if(obsolete)
+        return;
+
+    ++recovery.attempts;
+    recovery.lastRestart.start();
+    const auto reason = recovery.reason;
+
+    switch(component)
+    {
+    case WatchdogComponent::Worker:
+        onRestart();
+        break;
+    case WatchdogComponent::RxSocket:
+        if(!reopenSockets())
+            startWatchdog(QStringLiteral("Fail to bind the restarted rx socket"));
+        break;
+    case WatchdogComponent::TxSocket:
+        reopenTxSocket();
+        break;
+    case WatchdogComponent::MulticastTxSocket:
+    {
+        // Failing to create it again leave it to the output watcher
+        _p->failedToInstantiateMulticastTxSockets.erase(interfaceName);
+        createMulticastSocketForInterface(*snapshot->fromName(interfaceName));
+        break;
+    }
+    case WatchdogComponent::MulticastMembership:
+    {
+        // Failing again reschedule a restart, see 'joinAndTrackMulticastGroup'
+        joinAndTrackMulticastGroup(group, interfaceName, *snapshot);
+        break;
+    }
+    default:;
+    }
+
+    // Once restarted, a slot might stop the worker
+    Q_EMIT componentRestarted(component, interfaceName, group, reason);
+}
+
+void Worker::scheduleMembershipRecovery(const QString& address, const QString& ifaceName, const InterfacesSnapshot& snapshot)
+{
+    // Ifaces that are down are joined by the listening watcher once they are back
+    if(workerMulticastInterfaceValid(snapshot.fromName(ifaceName).get(), multicastLoopback()))
+        scheduleRecovery(WatchdogComponent::MulticastMembership, ifaceName, address, QStringLiteral("Fail to join ") + address);
+}
+
+void Worker::cancelRecoveries(WatchdogComponent component, const QString& interfaceName)
+{
+    for(auto it = _p->recoveries.begin(); it != _p->recoveries.end();)
+    {
+        const auto& [key, recovery] = *it;
+        if(std::get<0>(key) != component || std::get<1>(key) != interfaceName)
+        {
+            ++it;
+            continue;
+        }
+
+        if(recovery.timer)
+        {
+            disconnect(recovery.timer, nullptr, this, nullptr);
+            recovery.timer->stop();
+            recovery.timer->deleteLater();
+        }
+        it = _p->recoveries.erase(it);
+    }
+}
+
+void Worker::cancelRecoveries()
+{
+    for(auto& [key, recovery]: _p->recoveries)
+    {
+        if(recovery.timer)
         {
-            socket->setSocketOption(QAbstractSocket::SocketOption::MulticastLoopbackOption, _p->multicastLoopback);
+            disconnect(recovery.timer, nullptr, this, nullptr);
+            recovery.timer->stop();
+            recovery.timer->deleteLater();
+            recovery.timer = nullptr;
         }
     }
 }
 
-void Worker::startWatchdog()
+void Worker::reopenTxSocket()
 {
-    Q_EMIT queueStartWatchdog();
+    // The rx socket also send
+    if(!_p->rxSocket)
+    {
+        if(!reopenSockets())
+            startWatchdog(QStringLiteral("Fail to bind the restarted socket"));
+        return;
+    }
+
+    auto* const previousSocket = std::exchange(_p->socket, new QUdpSocket(this));
+    disconnect(previousSocket, nullptr, this, nullptr);
+    previousSocket->deleteLater();
+
+    connectSocketErrors(_p->socket);
+    if(_p->multicastTtl)
+        _p->socket->setSocketOption(QAbstractSocket::MulticastTtlOption, int(_p->multicastTxTtl()));
+    setMulticastLoopbackToSocket();
 }
 
-void Worker::stopWatchdog()
+void Worker::connectSocketErrors(QUdpSocket* socket)
 {
-    if(_p->watchdog)
-    {
-        disconnect(_p->watchdog, nullptr, this, nullptr);
-        _p->watchdog->stop();
-        _p->watchdog->deleteLater();
-        _p->watchdog = nullptr;
-    }
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+    connect(socket,
+        QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error),
+        this,
+        [this, socket](QAbstractSocket::SocketError error) { onSocketErrorCommon(error, socket); });
+#else
+    connect(socket,
+        QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::errorOccurred),
+        this,
+        [this, socket](QAbstractSocket::SocketError error) { onSocketErrorCommon(error, socket); });
+#endif
 }
 
 void Worker::setMulticastTtl(const quint8 ttl)
@@ -909,181 +2072,146 @@ void Worker::setMulticastTtl(const quint8 ttl)
     {
         // This should be set in case _p->multicastTxSockets is empty
         _p->multicastTtl = ttl;
-        _p->socket->setSocketOption(QAbstractSocket::MulticastTtlOption, int(_p->multicastTtl ? _p->multicastTtl : 8));
-        for(const auto& [ifaceName, socket]: _p->multicastTxSockets)
-        {
-            socket->setSocketOption(QAbstractSocket::SocketOption::MulticastTtlOption, int(_p->multicastTtl ? _p->multicastTtl : 8));
-        };
+        _p->socket->setSocketOption(QAbstractSocket::MulticastTtlOption, int(_p->multicastTxTtl()));
+
+        // Ttl is part of the pool key, sockets are borrowed again at next send
+        if(_p->multicastTxSocketsInstantiated)
+            destroyMulticastOutputSockets();
     }
 }
 
+int Worker::interfaceWatcherInterval()
+{
+    // Interfaces events are pushed by the monitor, timers only catch what it could miss
+    const auto* const monitor = InterfacesMonitor::instance();
+    return monitor && monitor->isActive() ? 10000 : 2500;
+}
+
+void Worker::onInterfacesChanged()
+{
+    // The watcher stop once every group is joined, but a change can still make an iface lost or a new one available.
+    // Retrying a join (re)start the watcher.
+    if(!_p->multicastGroups.empty() && rxSocket())
+        checkListeningMulticastInterfaces();
+    if(_p->outputMulticastInterfaceWatcherRunning())
+        checkOutputMulticastInterfaces();
+}
+
+void Worker::onInterfacesMonitorActiveChanged()
+{
+    // The monitor is opened from the application event loop, usually after the watchers started.
+    // Setting the interval of a running timer restart it.
+    const auto interval = interfaceWatcherInterval();
+    if(_p->listeningMulticastInterfaceWatcher)
+        _p->listeningMulticastInterfaceWatcher->setInterval(interval);
+    if(_p->outputMulticastInterfaceWatcher)
+        _p->outputMulticastInterfaceWatcher->setInterval(interval);
+}
+
 void Worker::startListeningMulticastInterfaceWatcher()
 {
     if(!_p->listeningMulticastInterfaceWatcher)
     {
         _p->listeningMulticastInterfaceWatcher = new QTimer(this);
 
-        _p->listeningMulticastInterfaceWatcher->setInterval(2500);
+        _p->listeningMulticastInterfaceWatcher->setInterval(interfaceWatcherInterval());
         _p->listeningMulticastInterfaceWatcher->setTimerType(Qt::VeryCoarseTimer);
         _p->listeningMulticastInterfaceWatcher->setSingleShot(false);
 
-        connect(
-            _p->listeningMulticastInterfaceWatcher,
+        connect(_p->listeningMulticastInterfaceWatcher,
             &QTimer::timeout,
             this,
-            [this]()
-            {
-                // Should be deleted if _p->multicastGroups is empty
-                Q_ASSERT(!_p->multicastGroups.empty());
-
-                // Fetch all ifaces
-                const auto allInterfaces = InterfacesProvider::allInterfaces();
+            &Worker::checkListeningMulticastInterfaces,
+            Qt::QueuedConnection);
 
-                // if auto joining every iface
-                if(_p->incomingMulticastInterfaces.empty())
-                {
-                    // Look for new iface to join. Every iface found are added to the '_p->failedJoiningMulticastGroup'.
-                    // They will be joined with the other failed to join one.
-                    for(const auto& iface: allInterfaces)
-                    {
-                        const auto ifaceName = iface->name();
-                        if(_p->allMulticastInterfaces.find(ifaceName) == _p->allMulticastInterfaces.end())
-                        {
-                            _p->allMulticastInterfaces.insert(ifaceName);
-                            _p->failedJoiningMulticastGroup.insert({ifaceName, _p->multicastGroups});
-                        }
-                    }
-
-                    std::vector<QString> ifaceNameToRemove;
-
-                    // Look for ifaces that disappear
-                    for(const auto& ifaceName: _p->allMulticastInterfaces)
-                    {
-                        bool found = false;
-
-                        // Search if iface is present
-                        for(const auto& iface: allInterfaces)
-                        {
-                            if(iface->name() == ifaceName)
-                            {
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        // If not add it to the list to delete later
-                        if(!found)
-                        {
-                            qCDebug(netudp_worker_log)
-                                << "Interface " << ifaceName << "  disappeared, It will be removed from tracked ifaces";
-
-                            ifaceNameToRemove.push_back(ifaceName);
-                        }
-                    }
-
-                    // And remove them
-                    for(const auto& ifaceName: ifaceNameToRemove)
-                    {
-                        const auto& ifaceJoinedIt = _p->joinedMulticastGroups.find(ifaceName);
-                        if(ifaceJoinedIt != _p->joinedMulticastGroups.end())
-                        {
-                            for(const auto& group: ifaceJoinedIt->second)
-                            {
-                                socketLeaveMulticastGroup(group, ifaceName);
-                            }
-
-                            _p->joinedMulticastGroups.erase(ifaceJoinedIt);
-                        }
-                        _p->failedJoiningMulticastGroup.erase(ifaceName);
-                        _p->allMulticastInterfaces.erase(ifaceName);
-                    }
-                }
+        _p->listeningMulticastInterfaceWatcher->start();
+    }
+}
 
-                std::vector<QString> disconnectedInterfaceList;
+void Worker::checkListeningMulticastInterfaces()
+{
+    // Should be deleted if _p->multicastGroups is empty
+    Q_ASSERT(!_p->multicastGroups.empty());
 
-                // Look for iface disconnection
-                for(const auto& [ifaceName, groups]: _p->joinedMulticastGroups)
-                {
-                    // Only try to reconnect to iface that seems valid
-                    if(const auto& iface = InterfacesProvider::interfaceFromName(ifaceName))
-                    {
-                        const bool ifaceValid = iface->isValid() && iface->isRunning() && iface->isUp()
-                                                && (iface->canMulticast() || (multicastLoopback() && iface->isLoopBack()));
-                        if(!ifaceValid)
-                        {
-                            qCDebug(netudp_worker_log) << "Interface " << ifaceName
-                                                       << " isn't valid anymore, It will be removed from joined ifaces. "
-                                                          "The worker will try to re join later the iface";
-                            const auto& currentGroups = _p->failedJoiningMulticastGroup[ifaceName];
-
-                            // Move the list of joined multicast group to the failed one.
-                            if(currentGroups.empty())
-                            {
-                                _p->failedJoiningMulticastGroup[ifaceName] = groups;
-                            }
-                            else
-                            {
-                                WorkerPrivate::MulticastGroupList newList;
-                                std::merge(currentGroups.begin(),
-                                    currentGroups.end(),
-                                    groups.begin(),
-                                    groups.end(),
-                                    std::inserter(newList, newList.begin()));
-                                _p->failedJoiningMulticastGroup[ifaceName] = newList;
-                            }
-
-                            // And request a delete later (since we are iterating in this map)
-                            disconnectedInterfaceList.push_back(ifaceName);
-                        }
-                    }
-                }
+    // Fetch all ifaces
+    const auto snapshot = InterfacesProvider::snapshot();
 
-                for(const auto& disconnectedInterfaceName: disconnectedInterfaceList)
-                    _p->joinedMulticastGroups.erase(disconnectedInterfaceName);
+    // Nothing changed since the last check, and nothing left to join again
+    if(snapshot->generation() == _p->listeningInterfacesGeneration && _p->failedMemberships.empty())
+    {
+        stopListeningMulticastInterfaceWatcher();
+        return;
+    }
+    _p->listeningInterfacesGeneration = snapshot->generation();
 
-                // Try to rejoin every groups
-                for(auto& [ifaceName, groups]: _p->failedJoiningMulticastGroup)
-                {
-                    // Only try to reconnect to iface that seems valid
-                    if(const auto& iface = InterfacesProvider::interfaceFromName(ifaceName))
-                    {
-                        const bool ifaceValid =
-                            iface->isValid() && iface->isRunning() && iface->isUp() && (multicastLoopback() && iface->isLoopBack());
-                        if(!ifaceValid)
-                            continue;
-                    }
+    // if auto joining every iface
+    if(_p->incomingMulticastInterfaces.empty())
+    {
+        // Look for new iface to join. Every group of the ifaces found are added to '_p->failedMemberships'.
+        // They will be joined with the other failed to join one.
+        for(const auto& iface: *snapshot)
+        {
+            const auto ifaceName = iface->name();
+            if(_p->allMulticastInterfaces.insert(ifaceName).second)
+            {
+                const auto ifaceId = _p->membershipInterfaceId(ifaceName);
+                for(const auto& group: _p->multicastGroups)
+                    _p->addFailedMembership({QHostAddress(group).toIPv6Address(), ifaceId}, group);
+            }
+        }
 
-                    std::vector<QString> successFullyJoinedGroup;
+        // Look for ifaces that disappear, and remove them
+        for(auto it = _p->allMulticastInterfaces.begin(); it != _p->allMulticastInterfaces.end();)
+        {
+            if(snapshot->fromName(*it))
+            {
+                ++it;
+                continue;
+            }
 
-                    for(const auto& group: groups)
-                    {
-                        if(joinAndTrackMulticastGroup(group, ifaceName))
-                            successFullyJoinedGroup.push_back(group);
-                    }
+            qCDebug(netudp_worker_log) << "Interface " << *it << "  disappeared, It will be removed from tracked ifaces";
+            leaveAndUntrackMulticastInterface(*it, *snapshot);
+            it = _p->allMulticastInterfaces.erase(it);
+        }
+    }
 
-                    for(const auto& group: successFullyJoinedGroup)
-                    {
-                        groups.erase(group);
-                    }
-                }
+    // Look for iface disconnection. Memberships of an iface are only walked once it is lost.
+    std::vector<bool> validInterfaces(_p->membershipInterfaces.size());
+    for(std::size_t i = 0; i < _p->membershipInterfaces.size(); ++i)
+    {
+        const auto ifaceName = _p->membershipInterfaces[i].name;
+        validInterfaces[i] = workerMulticastInterfaceValid(snapshot->fromName(ifaceName).get(), multicastLoopback());
+        if(validInterfaces[i] || !_p->membershipInterfaces[i].joined)
+            continue;
 
-                // Remove ifaces with empty group
-                for(auto it = _p->failedJoiningMulticastGroup.begin(); it != _p->failedJoiningMulticastGroup.end();)
-                {
-                    if(it->second.empty())
-                        it = _p->failedJoiningMulticastGroup.erase(it);
-                    else
-                        ++it;
-                }
+        qCDebug(netudp_worker_log) << "Interface " << ifaceName
+                                   << " isn't valid anymore, It will be removed from joined ifaces. "
+                                      "The worker will try to re join later the iface";
 
-                // Stop timer if nothing left to watch
-                if(_p->joinedMulticastGroups.empty() || _p->failedJoiningMulticastGroup.empty())
-                    stopListeningMulticastInterfaceWatcher();
-            },
-            Qt::QueuedConnection);
+        // Move the joined multicast groups to the failed ones. The os might keep them while the iface is down.
+        for(const auto& group: _p->joinedGroups(quint16(i)))
+        {
+            QString error;
+            const QHostAddress hostAddress(group);
+            leaveMembership(hostAddress, ifaceName, snapshot->fromName(ifaceName) != nullptr, error);
+            _p->addFailedMembership({hostAddress.toIPv6Address(), quint16(i)}, group);
+        }
+    }
 
-        _p->listeningMulticastInterfaceWatcher->start();
+    // Try to rejoin every groups, only on ifaces that seem valid
+    std::vector<std::pair<QString, QString>> rejoinedMemberships;
+    for(const auto& [membership, group]: _p->failedMemberships)
+    {
+        if(validInterfaces[membership.iface])
+            rejoinedMemberships.emplace_back(group, _p->membershipInterfaces[membership.iface].name);
     }
+
+    for(const auto& [group, ifaceName]: rejoinedMemberships)
+        joinAndTrackMulticastGroup(group, ifaceName, *snapshot);
+
+    // Stop timer if nothing left to watch
+    if(_p->memberships.empty() || _p->failedMemberships.empty())
+        stopListeningMulticastInterfaceWatcher();
 }
 
 void Worker::stopListeningMulticastInterfaceWatcher()
@@ -1098,104 +2226,124 @@ void Worker::stopListeningMulticastInterfaceWatcher()
 
 void Worker::startOutputMulticastInterfaceWatcher()
 {
-    if(!_p->outputMulticastInterfaceWatcher)
+    if(_p->outputMulticastInterfaceWatcherRunning())
+        return;
+
+    if(auto pool = MulticastTxSocketPool::instance())
+    {
+        connect(pool.get(), &MulticastTxSocketPool::maintenanceRequested, this, &Worker::checkOutputMulticastInterfaces);
+        pool->addWatcher();
+        _p->outputMulticastInterfaceWatcherPool = std::move(pool);
+    }
+    else
     {
         _p->outputMulticastInterfaceWatcher = new QTimer(this);
-        _p->outputMulticastInterfaceWatcher->setInterval(2500);
+        _p->outputMulticastInterfaceWatcher->setInterval(interfaceWatcherInterval());
         _p->outputMulticastInterfaceWatcher->setSingleShot(false);
         _p->outputMulticastInterfaceWatcher->setTimerType(Qt::VeryCoarseTimer);
 
-        connect(_p->outputMulticastInterfaceWatcher,
-            &QTimer::timeout,
-            this,
-            [this]()
-            {
-                // If too much time without datagram send, then we destroy every sockets
-                if(_p->txMulticastPacketElapsedTime.elapsed() > disableSocketTimeout)
-                {
-                    destroyMulticastOutputSockets();
-                    return;
-                }
+        connect(_p->outputMulticastInterfaceWatcher, &QTimer::timeout, this, &Worker::checkOutputMulticastInterfaces);
 
-                const auto allInterfaces = InterfacesProvider::allInterfaces();
+        _p->outputMulticastInterfaceWatcher->start();
+    }
+}
 
-                // When instantiating sockets for all ifaces, check if new ifaces appeared
-                if(_p->outgoingMulticastInterfaces.empty())
-                {
-                    // Try to find if new ifaces were created and try to join them
-                    for(const auto& iface: allInterfaces)
-                    {
-                        Q_CHECK_PTR(iface);
-                        const auto ifaceName = iface->name();
-                        const auto multicastTxSocketFound = _p->multicastTxSockets.find(ifaceName) != _p->multicastTxSockets.end();
-                        const auto multicastFailedToCreateFound =
-                            _p->failedToInstantiateMulticastTxSockets.find(ifaceName) != _p->failedToInstantiateMulticastTxSockets.end();
-
-                        // New iface detected, It's added to the list of _p->failedToInstantiateMulticastTxSockets
-                        // Then it will be instantiated by the step of the algorithm.
-                        if(!multicastFailedToCreateFound && !multicastTxSocketFound)
-                            _p->failedToInstantiateMulticastTxSockets.insert(ifaceName);
-                    }
-                }
+void Worker::checkOutputMulticastInterfaces()
+{
+    // If too much time without datagram send, then we destroy every sockets
+    if(_p->txMulticastPacketElapsedTime.elapsed() > disableSocketTimeout)
+    {
+        destroyMulticastOutputSockets();
+        return;
+    }
 
-                const auto isInterfacePresent = [&](const QString& ifaceName)
-                {
-                    for(const auto& iface: allInterfaces)
-                    {
-                        if(iface->name() == ifaceName)
-                            return true;
-                    }
-                    return false;
-                };
-
-                // Check for ifaces that are no longer here
-                for(auto it = _p->failedToInstantiateMulticastTxSockets.begin(); it != _p->failedToInstantiateMulticastTxSockets.end();)
-                {
-                    const auto ifaceName = *it;
-                    if(isInterfacePresent(ifaceName))
-                    {
-                        ++it;
-                    }
-                    else
-                    {
-                        qCDebug(netudp_worker_log)
-                            << "Detect iface " << ifaceName << " disappear, stop trying to instantiate a udp multicast socket for it";
-                        it = _p->failedToInstantiateMulticastTxSockets.erase(it);
-                    }
-                }
-                for(auto it = _p->multicastTxSockets.begin(); it != _p->multicastTxSockets.end();)
-                {
-                    const auto [ifaceName, socket] = *it;
-                    if(isInterfacePresent(ifaceName))
-                    {
-                        ++it;
-                    }
-                    else
-                    {
-                        qCDebug(netudp_worker_log) << "Detect iface " << ifaceName << "disappear, delete the associated multicast socket";
-                        socket->deleteLater();
-                        it = _p->multicastTxSockets.erase(it);
-                    }
-                }
+    // Ask the routes again and retry unhealthy ifaces
+    _p->multicastRoutes.clear();
+    _p->unhealthyMulticastTxInterfaces.clear();
 
-                const auto failedToInstantiateMulticastTxSocketsCopy = _p->failedToInstantiateMulticastTxSockets;
-                _p->failedToInstantiateMulticastTxSockets.clear();
+    const auto snapshot = InterfacesProvider::snapshot();
 
-                // Then check all the socket that failed to be instantiated and try again.
-                for(const auto& ifaceName: failedToInstantiateMulticastTxSocketsCopy)
-                {
-                    const auto iface = InterfacesProvider::interfaceFromName(ifaceName);
-                    Q_CHECK_PTR(iface);
-                    createMulticastSocketForInterface(*iface);
-                }
-            });
+    // When instantiating sockets for all ifaces, check if new ifaces appeared
+    if(_p->outgoingMulticastInterfaces.empty())
+    {
+        // Try to find if new ifaces were created and try to join them
+        for(const auto& iface: *snapshot)
+        {
+            Q_CHECK_PTR(iface);
+            const auto ifaceName = iface->name();
+            const auto multicastTxSocketFound = _p->multicastTxSockets.find(ifaceName) != _p->multicastTxSockets.end();
+            const auto multicastFailedToCreateFound =
+                _p->failedToInstantiateMulticastTxSockets.find(ifaceName) != _p->failedToInstantiateMulticastTxSockets.end();
+
+            // New iface detected, It's added to the list of _p->failedToInstantiateMulticastTxSockets
+            // Then it will be instantiated by the step of the algorithm.
+            if(!multicastFailedToCreateFound && !multicastTxSocketFound)
+                _p->failedToInstantiateMulticastTxSockets.insert(ifaceName);
+        }
+    }
 
-        _p->outputMulticastInterfaceWatcher->start();
+    const auto isInterfacePresent = [&](const QString& ifaceName)
+    {
+        return snapshot->fromName(ifaceName) != nullptr;
+    };
+
+    // Check for ifaces that are no longer here
+    for(auto it = _p->failedToInstantiateMulticastTxSockets.begin(); it != _p->failedToInstantiateMulticastTxSockets.end();)
+    {
+        const auto ifaceName = *it;
+        if(isInterfacePresent(ifaceName))
+        {
+            ++it;
+        }
+        else
+        {
+            qCDebug(netudp_worker_log)
+                << "Detect iface " << ifaceName << " disappear, stop trying to instantiate a udp multicast socket for it";
+            it = _p->failedToInstantiateMulticastTxSockets.erase(it);
+        }
+    }
+    for(auto it = _p->multicastTxSockets.begin(); it != _p->multicastTxSockets.end();)
+    {
+        const auto [ifaceName, socket] = *it;
+        const auto iface = snapshot->fromName(ifaceName);
+        if(iface && iface->index() == socket.index)
+        {
+            ++it;
+        }
+        else
+        {
+            qCDebug(netudp_worker_log) << "Detect iface " << ifaceName << (iface ? "was recreated" : "disappear")
+                                       << ", release the associated multicast socket";
+            MulticastTxSocketPool::release(ifaceName, socket.index, socket.ttl, socket.loopback);
+            it = _p->multicastTxSockets.erase(it);
+
+            // A recreated iface get a socket with its new index below
+            if(iface)
+                _p->failedToInstantiateMulticastTxSockets.insert(ifaceName);
+        }
+    }
+
+    const auto failedToInstantiateMulticastTxSocketsCopy = _p->failedToInstantiateMulticastTxSockets;
+    _p->failedToInstantiateMulticastTxSockets.clear();
+
+    // Then check all the socket that failed to be instantiated and try again.
+    // Ifaces that disappeared were removed above, so every one is in the snapshot.
+    for(const auto& ifaceName: failedToInstantiateMulticastTxSocketsCopy)
+    {
+        const auto iface = snapshot->fromName(ifaceName);
+        Q_CHECK_PTR(iface);
+        createMulticastSocketForInterface(*iface);
     }
 }
 
 void Worker::stopOutputMulticastInterfaceWatcher()
 {
+    if(const auto pool = std::exchange(_p->outputMulticastInterfaceWatcherPool, nullptr))
+    {
+        disconnect(pool.get(), nullptr, this, nullptr);
+        pool->removeWatcher();
+    }
+
     if(_p->outputMulticastInterfaceWatcher)
     {
         disconnect(_p->outputMulticastInterfaceWatcher, nullptr, this, nullptr);
@@ -1224,37 +2372,19 @@ void Worker::createMulticastSocketForInterface(const IInterface& iface)
             return false;
         }
 
-        auto socket = new QUdpSocket(this);
-        qCDebug(netudp_worker_log) << "Create multicast tx socket for iface " << ifaceName;
+        WorkerPrivate::MulticastTxSocket socket;
+        socket.ttl = _p->multicastTxTtl();
+        socket.loopback = _p->multicastLoopback;
+        socket.index = iface.index();
 
-        if(!socket->bind(QHostAddress(QHostAddress::AnyIPv4), 0, QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint))
+        QString error;
+        socket.descriptor = MulticastTxSocketPool::acquire(iface, socket.ttl, socket.loopback, &error);
+        if(socket.descriptor == -1)
         {
-            socket->deleteLater();
+            qCWarning(netudp_worker_log) << "Fail to create multicast tx socket for iface " << ifaceName << ", error : " << error;
             return false;
         }
 
-        socket->setMulticastInterface(QNetworkInterface::interfaceFromName(ifaceName));
-        socket->setSocketOption(QAbstractSocket::SocketOption::MulticastLoopbackOption, _p->multicastLoopback);
-
-        //const auto returnedInterface = socket->multicastInterface();
-        //LOG_DEV_INFO("returnedInterface.isValid : {}", returnedInterface.isValid());
-        //LOG_DEV_INFO("returnedInterface.name : {}", returnedInterface.name().toStdString());
-
-        const auto onError = [ifaceName, socket, this](QAbstractSocket::SocketError error)
-        {
-            qCWarning(netudp_worker_log) << ifaceName << ": Multicast tx error: " << socket->errorString();
-            socket->deleteLater();
-            _p->multicastTxSockets.erase(ifaceName);
-            _p->failedToInstantiateMulticastTxSockets.insert(ifaceName);
-        };
-
-        // Connect to socket signals
-#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-        connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error), this, onError, Qt::QueuedConnection);
-#else
-        connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::errorOccurred), this, onError, Qt::QueuedConnection);
-#endif
-
         const auto [it, success] = _p->multicastTxSockets.insert({ifaceName, socket});
 
         // This have been checked before creating the socket if(_p->multicastTxSockets.find(ifaceName) != _p->multicastTxSockets.end())
@@ -1303,71 +2433,105 @@ void Worker::createMulticastOutputSockets()
     _p->multicastTxSocketsInstantiated = true;
 }
 
-void Worker::destroyMulticastOutputSockets()
+void Worker::releaseMulticastTxSockets()
 {
     for(const auto& [ifaceName, socket]: _p->multicastTxSockets)
-    {
-        Q_CHECK_PTR(socket);
-        socket->deleteLater();
-    }
+        MulticastTxSocketPool::release(ifaceName, socket.index, socket.ttl, socket.loopback);
     _p->multicastTxSockets.clear();
-    _p->failedJoiningMulticastGroup.clear();
+}
+
+void Worker::destroyMulticastOutputSockets()
+{
+    releaseMulticastTxSockets();
+    _p->failedToInstantiateMulticastTxSockets.clear();
+    _p->multicastRoutes.clear();
+    _p->unhealthyMulticastTxInterfaces.clear();
     stopOutputMulticastInterfaceWatcher();
     _p->multicastTxSocketsInstantiated = false;
 }
 
 void Worker::onSendDatagram(const SharedDatagram& datagram)
 {
-    if(!isBounded())
+    if(!datagram)
     {
-        qCWarning(netudp_worker_log) << "Can't send datagram if socket isn't bounded";
+        qCWarning(netudp_worker_log) << "Can't send null datagram";
         return;
     }
-    if(!datagram)
+
+    // Only access the buffer through the const api, so implicitly shared storage is never detached
+    const Datagram& constDatagram = *datagram;
+
+    if(!constDatagram.buffer())
     {
-        qCWarning(netudp_worker_log) << "Can't send null datagram";
+        qCWarning(netudp_worker_log) << "Can't send datagram with empty buffer";
         return;
     }
 
-    if(!_p->socket)
+    const ConstBuffer buffer(constDatagram.buffer(), constDatagram.length());
+    writeDatagram(&buffer, 1, constDatagram.destinationAddress, constDatagram.destinationPort, constDatagram.ttl);
+}
+
+void Worker::onSendDatagramV(const netudp::ConstBufferList& buffers, const QString& address, const quint16 port, const quint8 ttl)
+{
+    for(const auto& buffer: buffers)
     {
-        qCWarning(netudp_worker_log) << "Can't send a datagram when the socket is null";
+        if(!buffer.data && buffer.length)
+        {
+            qCWarning(netudp_worker_log) << "Can't send datagram with a null buffer";
+            return;
+        }
+    }
+
+    writeDatagram(buffers.data(), buffers.size(), address, port, ttl);
+}
+
+void Worker::writeDatagram(const ConstBuffer* buffers, std::size_t count, const QString& address, const quint16 port, const quint8 ttl)
+{
+    if(!isBounded())
+    {
+        qCWarning(netudp_worker_log) << "Can't send datagram if socket isn't bounded";
         return;
     }
 
-    if(datagram->destinationAddress.isNull())
+    if(!_p->socket)
     {
-        qCWarning(netudp_worker_log) << "Can't send datagram to null address";
+        qCWarning(netudp_worker_log) << "Can't send a datagram when the socket is null";
         return;
     }
 
-    if(!datagram->buffer())
+    if(address.isNull())
     {
-        qCWarning(netudp_worker_log) << "Can't send datagram with empty buffer";
+        qCWarning(netudp_worker_log) << "Can't send datagram to null address";
         return;
     }
 
-    if(!datagram->length())
+    qint64 length = 0;
+    for(std::size_t i = 0; i < count; ++i)
+        length += qint64(buffers[i].length);
+
+    if(!length)
     {
         qCWarning(netudp_worker_log) << "Can't send datagram with data length to 0";
         return;
     }
 
-    const auto bytesWritten = [&]()
+    const auto bytesWritten = [&]() -> qint64
     {
-        const QHostAddress host(datagram->destinationAddress);
+        const QHostAddress host(address);
         const bool isMulticast = host.isMulticast();
 
         // Can't set ttl with qt api by passing a const char* buffer, we need to copy to QByteArray
-        if(datagram->ttl && !isMulticast)
+        if(ttl && !isMulticast)
         {
             // Copy will happen :(
             // Don't have other choice in order to set ttl
-            QNetworkDatagram d(QByteArray(reinterpret_cast<const char*>(datagram->buffer()), int(datagram->length())),
-                host,
-                datagram->destinationPort);
+            QByteArray data;
+            data.reserve(int(length));
+            for(std::size_t i = 0; i < count; ++i)
+                data.append(reinterpret_cast<const char*>(buffers[i].data), int(buffers[i].length));
 
-            d.setHopLimit(datagram->ttl ? datagram->ttl : -1);
+            QNetworkDatagram d(data, host, port);
+            d.setHopLimit(ttl);
             return _p->socket->writeDatagram(d);
         }
 
@@ -1379,22 +2543,7 @@ void Worker::onSendDatagram(const SharedDatagram& datagram)
 
             if(!_p->multicastTxSockets.empty())
             {
-                bool byteWrittenInitialized = false;
-                qint64 bytes = 0;
-                for(const auto& [ifaceName, socket]: _p->multicastTxSockets)
-                {
-                    socket->setSocketOption(QAbstractSocket::MulticastTtlOption, int(_p->multicastTtl ? _p->multicastTtl : 8));
-                    const auto currentBytesWritten = socket->writeDatagram(reinterpret_cast<const char*>(datagram->buffer()),
-                        datagram->length(),
-                        host,
-                        datagram->destinationPort);
-
-                    if(!byteWrittenInitialized)
-                    {
-                        byteWrittenInitialized = true;
-                        bytes = currentBytesWritten;
-                    }
-                }
+                const auto bytes = writeMulticastDatagram(buffers, count, address, host, port);
 
                 // _timeSinceNoTxMulticastDatagram can't be null when _p->multicastTxSockets are instantiated
                 _p->txMulticastPacketElapsedTime.start();
@@ -1402,29 +2551,42 @@ void Worker::onSendDatagram(const SharedDatagram& datagram)
             }
         }
 
-        return _p->socket->writeDatagram(reinterpret_cast<const char*>(datagram->buffer()),
-            datagram->length(),
-            host,
-            datagram->destinationPort);
+        return NativeSocket::writeDatagram(_p->socket, buffers, count, host, port);
     }();
 
-    if(bytesWritten <= 0 || bytesWritten != datagram->length())
+    // Only the multicast tx sockets that failed are restarted. They are released now, so next datagrams use the others.
+    const auto failedMulticastTxInterfaces = std::exchange(_p->failedMulticastTxInterfaces, {});
+    for(const auto& ifaceName: failedMulticastTxInterfaces)
+    {
+        const auto it = _p->multicastTxSockets.find(ifaceName);
+        if(it == _p->multicastTxSockets.end())
+            continue;
+
+        MulticastTxSocketPool::release(ifaceName, it->second.index, it->second.ttl, it->second.loopback);
+        _p->multicastTxSockets.erase(it);
+        scheduleRecovery(WatchdogComponent::MulticastTxSocket, ifaceName, {}, QStringLiteral("Fail to send datagram to ") + address);
+    }
+
+    if(bytesWritten <= 0 || bytesWritten != length)
     {
-        startWatchdog();
+        const auto reason = bytesWritten <= 0 ? QStringLiteral("Fail to send datagram, 0 bytes written")
+                                              : QStringLiteral("Fail to send datagram, %1/%2 bytes written").arg(bytesWritten).arg(length);
 
         if(bytesWritten <= 0)
         {
-            qCWarning(netudp_worker_log) << "Fail to send datagram to " << datagram->destinationAddress << ":" << datagram->destinationPort
-                                         << ", 0 bytes written out of " << datagram->length() << ". Restart Socket. "
-                                         << _p->socket->errorString();
+            qCWarning(netudp_worker_log) << "Fail to send datagram to " << address << ":" << port << ", 0 bytes written out of "
+                                         << static_cast<long long>(length) << ". Restart Socket. " << _p->socket->errorString();
         }
         else
         {
             qCWarning(netudp_worker_log) << "Fail to send datagram, " << static_cast<long long>(bytesWritten) << "/"
-                                         << static_cast<long long>(datagram->length()) << " bytes written. Restart Socket. "
+                                         << static_cast<long long>(length) << " bytes written. Restart Socket. "
                                          << _p->socket->errorString();
         }
 
+        if(failedMulticastTxInterfaces.empty())
+            scheduleRecovery(_p->rxSocket ? WatchdogComponent::TxSocket : WatchdogComponent::RxSocket, {}, {}, reason);
+
         return;
     }
 
@@ -1432,12 +2594,127 @@ void Worker::onSendDatagram(const SharedDatagram& datagram)
     ++_p->txPacketsCounter;
 }
 
+qint64 Worker::writeMulticastDatagram(
+    const ConstBuffer* buffers, std::size_t count, const QString& address, const QHostAddress& host, quint16 port)
+{
+    ++_p->txMulticastPackets;
+
+    qint64 length = 0;
+    for(std::size_t i = 0; i < count; ++i)
+        length += qint64(buffers[i].length);
+
+    const auto write = [&](const QString& ifaceName, const WorkerPrivate::MulticastTxSocket& socket)
+    {
+        ++_p->txMulticastWrites;
+        const auto bytes = NativeSocket::writeDatagram(socket.descriptor, buffers, count, host, port);
+        if(bytes != length)
+            _p->failedMulticastTxInterfaces.push_back(ifaceName);
+        return bytes;
+    };
+
+    // Write on every socket in 'sockets' that pass 'filter', and return the bytes of the first write. -1 if nothing was written.
+    const auto writeEach = [&](const auto& filter)
+    {
+        bool byteWrittenInitialized = false;
+        qint64 bytes = -1;
+        for(const auto& [ifaceName, socket]: _p->multicastTxSockets)
+        {
+            if(!filter(ifaceName, socket))
+                continue;
+
+            const auto currentBytesWritten = write(ifaceName, socket);
+            if(!byteWrittenInitialized)
+            {
+                byteWrittenInitialized = true;
+                bytes = currentBytesWritten;
+            }
+        }
+        return std::make_pair(byteWrittenInitialized, bytes);
+    };
+
+    // Explicit ifaces of the group win over the policy, as long as one of them has a socket
+    const auto egressInterfaces = _p->multicastEgressInterfaces.find(address);
+    if(egressInterfaces != _p->multicastEgressInterfaces.end())
+    {
+        const auto [written, bytes] = writeEach(
+            [&](const QString& ifaceName, const WorkerPrivate::MulticastTxSocket&)
+            {
+                return egressInterfaces->second.find(ifaceName) != egressInterfaces->second.end();
+            });
+        if(written)
+            return bytes;
+    }
+
+    switch(_p->multicastEgressPolicy)
+    {
+    case MulticastEgressPolicy::RouteTable:
+    {
+        const auto index = _p->multicastRouteInterfaceIndex(address, host);
+        const auto [written, bytes] = writeEach(
+            [&](const QString&, const WorkerPrivate::MulticastTxSocket& socket)
+            {
+                return index && socket.index == index;
+            });
+        if(written)
+            return bytes;
+
+        // No route, or the route go through an iface without socket
+        break;
+    }
+    case MulticastEgressPolicy::FirstHealthy:
+    {
+        bool writeTried = false;
+        for(const auto& [ifaceName, socket]: _p->multicastTxSockets)
+        {
+            if(_p->unhealthyMulticastTxInterfaces.find(ifaceName) != _p->unhealthyMulticastTxInterfaces.end())
+                continue;
+
+            writeTried = true;
+            const auto bytes = write(ifaceName, socket);
+            if(bytes > 0)
+                return bytes;
+
+            qCDebug(netudp_worker_log) << "Fail to send multicast datagram on " << ifaceName << ", try the next interface";
+            _p->unhealthyMulticastTxInterfaces.insert(ifaceName);
+        }
+
+        // Every iface failed, they are all tried again at next datagram
+        _p->unhealthyMulticastTxInterfaces.clear();
+        if(writeTried)
+            return -1;
+        break;
+    }
+    case MulticastEgressPolicy::AllInterfaces:
+    default:;
+    }
+
+    return writeEach(
+        [](const QString&, const WorkerPrivate::MulticastTxSocket&)
+        {
+            return true;
+        })
+        .second;
+}
+
 bool Worker::isPacketValid(const uint8_t* buffer, const size_t length) const
 {
     return buffer && length;
 }
 
 void Worker::readPendingDatagrams()
+{
+    if(!rxSocket())
+        return;
+
+    // Any of the membership shards
+    auto* socket = qobject_cast<QUdpSocket*>(sender());
+    if(!socket)
+        socket = rxSocket();
+
+    readSocketDatagrams(socket);
+}
+
+void Worker::readSocketDatagrams(QUdpSocket* socket)
 {
     if(!rxSocket())
         return;
@@ -1445,9 +2722,9 @@ void Worker::readPendingDatagrams()
     if(!_p->inputEnabled)
         return;
 
-    while(rxSocket() && rxSocket()->isValid() && rxSocket()->hasPendingDatagrams())
+    while(rxSocket() && socket->isValid() && socket->hasPendingDatagrams())
     {
-        if(rxSocket()->pendingDatagramSize() == 0)
+        if(socket->pendingDatagramSize() == 0)
         {
             qCWarning(netudp_worker_log) << "Receive datagram with size 0. This may means : \n"
                                             "- That host is unreachable (receive an ICMP packet destination unreachable).\n"
@@ -1457,11 +2734,11 @@ void Worker::readPendingDatagrams()
             // This might happen, so don't close socket.
             // This will cause an error  Connection reset by peer, that we need to ignore
             // If we don't read, then we won't receive data anymore
-            rxSocket()->receiveDatagram(0);
+            socket->receiveDatagram(0);
             return;
         }
 
-        QNetworkDatagram datagram = rxSocket()->receiveDatagram();
+        QNetworkDatagram datagram = socket->receiveDatagram();
 
         if(!datagram.isValid())
         {
@@ -1469,7 +2746,7 @@ void Worker::readPendingDatagrams()
                                             "This may be a sign that your OS doesn't support IGMP. On unix system you can "
                                             "check with netstat -g";
             ++_p->rxInvalidPacket;
-            startWatchdog();
+            scheduleRecovery(WatchdogComponent::RxSocket, {}, {}, QStringLiteral("Receive an invalid datagram"));
             return;
         }
 
@@ -1477,7 +2754,7 @@ void Worker::readPendingDatagrams()
         {
             qCWarning(netudp_worker_log) << "Receive datagram with size {}. Restart Socket.", datagram.data().size();
             ++_p->rxInvalidPacket;
-            startWatchdog();
+            scheduleRecovery(WatchdogComponent::RxSocket, {}, {}, QStringLiteral("Receive an empty datagram"));
             return;
         }
 
@@ -1493,11 +2770,19 @@ void Worker::readPendingDatagrams()
             qCWarning(netudp_worker_log) << "Receive a datagram with size of " << datagram.data().size()
                                          << ", that is too big for a datagram. Restart Socket.";
             ++_p->rxInvalidPacket;
-            startWatchdog();
+            scheduleRecovery(WatchdogComponent::RxSocket, {}, {}, QStringLiteral("Receive a datagram bigger than 65535 bytes"));
             return;
         }
 
         SharedDatagram sharedDatagram = makeDatagram(datagram.data().size());
+
+        // Drop before the copy when the process is short on rx memory. The datagram simply go back to the cache.
+        if(!sharedDatagram->acquireBudget(RxMemoryBudget::instance(), _p->rxBudgetWeight))
+        {
+            ++_p->rxBudgetDropped;
+            continue;
+        }
+
         memcpy(sharedDatagram.get()->buffer(), reinterpret_cast<const uint8_t*>(datagram.data().constData()), datagram.data().size());
         sharedDatagram->destinationAddress = datagram.destinationAddress().toString();
         if(datagram.destinationPort() >= 0)
@@ -1556,7 +2841,10 @@ void Worker::onSocketErrorCommon(QAbstractSocket::SocketError error, QUdpSocket*
         }
         qCWarning(netudp_worker_log) << "Socket Error (" << error << ") : " << socket->errorString();
         Q_EMIT socketError(error, socket->errorString());
-        startWatchdog();
+
+        // Unicast tx socket, when not also the rx one. Membership shards are rx sockets.
+        const auto component = socket == _p->socket && _p->rxSocket ? WatchdogComponent::TxSocket : WatchdogComponent::RxSocket;
+        scheduleRecovery(component, {}, {}, socket->errorString());
     }
 }
 
@@ -1601,12 +2889,20 @@ void Worker::startBytesCounter()
             Q_EMIT rxPacketsCounterChanged(_p->rxPacketsCounter);
             Q_EMIT txPacketsCounterChanged(_p->txPacketsCounter);
             Q_EMIT rxInvalidPacketsCounterChanged(_p->rxInvalidPacket);
+            Q_EMIT rxBudgetDroppedCounterChanged(_p->rxBudgetDropped);
+            Q_EMIT txMulticastCounterChanged(_p->txMulticastPackets, _p->txMulticastWrites);
+
+            _p->cache.adapt(_p->bytesCounterTimer->interval());
+            Q_EMIT cacheStatisticsChanged(_p->cache.statistics());
 
             _p->rxBytesCounter = 0;
             _p->txBytesCounter = 0;
             _p->rxPacketsCounter = 0;
             _p->txPacketsCounter = 0;
             _p->rxInvalidPacket = 0;
+            _p->rxBudgetDropped = 0;
+            _p->txMulticastPackets = 0;
+            _p->txMulticastWrites = 0;
         });
     _p->bytesCounterTimer->start();
 }
@@ -11,11 +11,16 @@
 
 #include <NetUdp/Export.hpp>
 #include <NetUdp/Datagram.hpp>
+#include <NetUdp/ConstBuffer.hpp>
+#include <NetUdp/DatagramPool.hpp>
+#include <NetUdp/MulticastEgressPolicy.hpp>
+#include <NetUdp/WatchdogComponent.hpp>
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtNetwork/QAbstractSocket>
 
 QT_FORWARD_DECLARE_CLASS(QUdpSocket);
+QT_FORWARD_DECLARE_CLASS(QHostAddress);
 
 #include <set>
 #include <memory>
@@ -23,6 +28,7 @@ QT_FORWARD_DECLARE_CLASS(QUdpSocket);
 namespace netudp {
 
 class IInterface;
+class InterfacesSnapshot;
 struct WorkerPrivate;
 
 class NETUDP_API_ Worker : public QObject
@@ -47,17 +53,49 @@ public:
 
     QUdpSocket* rxSocket() const;
 
+    // Configured size of the cache, see DatagramPool::size. cacheSize(sizeClass) follow the adaptive policy.
     size_t cacheSize() const;
     bool resizeCache(size_t length);
+    size_t cacheSize(DatagramPool::SizeClass sizeClass) const;
+    bool resizeCache(DatagramPool::SizeClass sizeClass, size_t length);
     void clearCache();
     void releaseCache();
+    DatagramPoolStatistics cacheStatistics() const;
+    DatagramPoolStatistics cacheStatistics(DatagramPool::SizeClass sizeClass) const;
+
+    // Number of datagrams allocated in each size class at start and each time the cache is resized, rather than on demand.
+    // Bounded by the size of each class, 0 (default) disable prewarm. Should be set before start, from the thread owning the worker.
+    std::size_t cachePrewarmCount() const;
+    void setCachePrewarmCount(std::size_t count);
+    DatagramPool::HugePages cacheHugePages() const;
+    void setCacheHugePages(DatagramPool::HugePages hugePages);
+
+    // Applied every second, with the bytes counters
+    const DatagramPoolAdaptivePolicy& cacheAdaptivePolicy() const;
+    void setCacheAdaptivePolicy(const DatagramPoolAdaptivePolicy& policy);
     virtual std::shared_ptr<Datagram> makeDatagram(const size_t length);
 
+    // Share of RxMemoryBudget::instance() this worker can use before dropping received datagrams, in [0, 1].
+    qreal rxBudgetWeight() const;
+
+    // Multicast memberships joined on a single rx socket before another one is bound to the same port.
+    quint32 maxMembershipsPerSocket() const;
+
+    // Only receive multicast groups joined by this worker (IP_MULTICAST_ALL disabled, Linux only).
+    bool multicastStrictFiltering() const;
+    // Bind one rx socket per group address, so groups joined by other sockets on the same port are filtered too.
+    bool multicastGroupSockets() const;
+
+    // Interfaces each multicast datagram is written on, for groups without explicit egress interfaces.
+    MulticastEgressPolicy multicastEgressPolicy() const;
+
     // ──────── STATUS CONTROL ────────
 public Q_SLOTS:
     void onRestart();
     void onStart();
     void onStop();
+    // 'onStop', then emit 'stopped'
+    void onStopRequested();
 
 public:
     void initialize(quint64 watchdog,
@@ -73,12 +111,19 @@ public:
 
 Q_SIGNALS:
     void isBoundedChanged(const bool isBounded);
+    void stopped();
     void socketError(int error, const QString description);
 
     void multicastGroupJoined(QString group, QString interfaceName);
     void multicastGroupLeaved(QString group, QString interfaceName);
 
 public Q_SLOTS:
+    // Batch the changes of rx address/port, tx port, input, separate sockets and multicast filtering until the matching
+    // 'endReconfiguration'. Sockets are then opened again once, and only if their configuration changed.
+    // New sockets are bound and join the multicast groups before previous ones are closed.
+    void beginReconfiguration();
+    void endReconfiguration();
+
     void setWatchdogTimeout(const quint64 ms);
 
     // Unicast/Multicast - Input
@@ -95,6 +140,11 @@ public Q_SLOTS:
 
     void joinMulticastGroup(const QString& address);
     void leaveMulticastGroup(const QString& address);
+    // Leave 'left' and join 'joined' in one pass. Groups present in neither list are untouched.
+    void updateMulticastGroups(const QStringList& joined, const QStringList& left);
+    // Only receive 'sources' on 'address', or every source but 'sources' when 'exclude' is true. Empty 'sources' remove the filter.
+    // Already joined ifaces are joined again with the new filter.
+    void setMulticastSourceFilter(const QString& address, const bool exclude, const QStringList& sources);
 
     // Join every addresses in '_multicastGroups' on interface with name 'interfaceName'
     void joinMulticastInterface(const QString& interfaceName);
@@ -106,50 +156,125 @@ public Q_SLOTS:
     // Multicast - Output
 
     void setMulticastOutgoingInterfaces(const QStringList& interfaces);
+    void setMulticastEgressPolicy(const netudp::MulticastEgressPolicy policy);
+    // Only send to 'address' on 'interfaces'. An empty list fallback to the egress policy.
+    void setMulticastEgressInterfaces(const QString& address, const QStringList& interfaces);
 
     // Create a different socket for unicast rx and multicast tx
     void setSeparateRxTxSockets(const bool separateRxTxSocketsChanged);
 
+    void setRxBudgetWeight(const qreal weight);
+    void setMaxMembershipsPerSocket(const quint32 count);
+    void setMulticastStrictFiltering(const bool enabled);
+    void setMulticastGroupSockets(const bool enabled);
+
 private:
+    // Create, connect and bind the unicast and rx sockets, then join multicast groups. Return false when the bind failed.
+    bool openSockets();
+    // Apply the attributes changed outside of a batch right away, or mark them pending until 'endReconfiguration'
+    void requestReconfiguration();
+    void reconfigure();
+
     void tryJoinAllAvailableInterfaces();
     void tryLeaveAllAvailableInterfaces();
 
-    bool joinAndTrackMulticastGroup(const QString& address, const QString& interfaceName);
+    // Ifaces are resolved in 'snapshot', taken once by callers that join or leave many groups.
+    bool joinAndTrackMulticastGroup(const QString& address, const QString& interfaceName, const InterfacesSnapshot& snapshot);
+    void leaveAndUntrackMulticastGroup(const QString& address, const InterfacesSnapshot& snapshot);
+    void leaveAndUntrackMulticastInterface(const QString& interfaceName, const InterfacesSnapshot& snapshot);
+
+    bool socketJoinMulticastGroup(const QString& address, const QString& interfaceName, const InterfacesSnapshot& snapshot);
+    bool socketLeaveMulticastGroup(const QString& address, const QString& interfaceName, const InterfacesSnapshot& snapshot);
+    // Apply the source filter of 'address' to its membership on 'interfaceName', the group is left on failure.
+    bool socketUpdateMulticastSourceFilter(const QString& address, const QString& interfaceName, const InterfacesSnapshot& snapshot);
 
-    bool socketJoinMulticastGroup(const QString& address, const QString& interfaceName);
-    bool socketLeaveMulticastGroup(const QString& address, const QString& interfaceName);
+    // Forget the membership, and leave it at os level on its shard if 'interfaceValid'.
+    bool leaveMembership(const QHostAddress& group, const QString& interfaceName, bool interfaceValid, QString& error);
+    // Index of a shard with room for one more membership of 'group', a new rx socket is bound when all are full. -1 on failure.
+    int availableMembershipShard(const QHostAddress& group);
+    // Bind a new rx socket to 'address':rxPort, that only receive its own memberships.
+    QUdpSocket* createMembershipSocket(const QHostAddress& address);
+    void destroyMembershipShards();
 
     void setMulticastLoopbackToSocket() const;
-    void startWatchdog();
+    // Restart every socket, after a backoff delay
+    void startWatchdog(const QString& reason);
     void stopWatchdog();
+
+    // Restart only 'component' after a backoff delay. 'interfaceName' and 'group' identify multicast components.
+    void scheduleRecovery(WatchdogComponent component, const QString& interfaceName, const QString& group, const QString& reason);
+    void recover(WatchdogComponent component, const QString& interfaceName, const QString& group);
+    // Join 'address' on 'interfaceName' again later, unless the iface is down
+    void scheduleMembershipRecovery(const QString& address, const QString& interfaceName, const InterfacesSnapshot& snapshot);
+    // Pending restarts are cancelled, backoff of each component is kept
+    void cancelRecoveries();
+    // Pending restarts of 'component' on 'interfaceName' are cancelled, and their backoff forgotten
+    void cancelRecoveries(WatchdogComponent component, const QString& interfaceName);
+
+    // Open new sockets, then close the previous ones once the new ones are bound. Multicast tx sockets are untouched.
+    bool reopenSockets();
+    // Replace the unicast tx socket, when separated from the rx socket
+    void reopenTxSocket();
+    void connectSocketErrors(QUdpSocket* socket);
     void setMulticastTtl(const quint8 ttl);
 
     void startListeningMulticastInterfaceWatcher();
     void stopListeningMulticastInterfaceWatcher();
+    // Join new/restored ifaces and leave lost ones. Called by the watcher timer, or as soon as InterfacesMonitor report a change.
+    void checkListeningMulticastInterfaces();
+
+    static int interfaceWatcherInterval();
+
+private Q_SLOTS:
+    void onInterfacesChanged();
+    // Timers poll slower while the monitor push interfaces events, follow its state
+    void onInterfacesMonitorActiveChanged();
+
     // ──────── MULTICAST TX JOIN WATCHER ────────
 private:
     void startOutputMulticastInterfaceWatcher();
     void stopOutputMulticastInterfaceWatcher();
+    // Create sockets for new/restored ifaces and delete the one of lost ifaces.
+    void checkOutputMulticastInterfaces();
 
     void createMulticastSocketForInterface(const IInterface& iface);
 
     void createMulticastOutputSockets();
     void destroyMulticastOutputSockets();
+    // Give back every socket borrowed from MulticastTxSocketPool
+    void releaseMulticastTxSockets();
 
 Q_SIGNALS:
     // Private signal
     void queueStartWatchdog();
 
+    // Emitted each time a component is restarted, with the failure that caused it
+    void componentRestarted(netudp::WatchdogComponent component, const QString interfaceName, const QString group, const QString reason);
+
     // ──────── TX ────────
 public Q_SLOTS:
     virtual void onSendDatagram(const SharedDatagram& datagram);
 
+    // Send every buffers as one datagram, without concatenating them.
+    virtual void onSendDatagramV(const netudp::ConstBufferList& buffers, const QString& address, const quint16 port, const quint8 ttl);
+
+private:
+    // Write 'count' buffers as a single datagram, and update counters/watchdog.
+    void writeDatagram(const ConstBuffer* buffers, std::size_t count, const QString& address, const quint16 port, const quint8 ttl);
+    // Write on the multicast tx sockets chosen by the egress interfaces of 'address', or by the egress policy.
+    // Return the bytes written by the first write.
+    qint64 writeMulticastDatagram(
+        const ConstBuffer* buffers, std::size_t count, const QString& address, const QHostAddress& host, quint16 port);
+
     // ──────── RX ────────
 protected:
     virtual bool isPacketValid(const uint8_t* buffer, const size_t length) const;
 private Q_SLOTS:
     void readPendingDatagrams();
 
+private:
+    void readSocketDatagrams(QUdpSocket* socket);
+
 protected:
     virtual void onDatagramReceived(const SharedDatagram& datagram);
 Q_SIGNALS:
@@ -178,6 +303,10 @@ Q_SIGNALS:
     void rxPacketsCounterChanged(const quint64 rx);
     void txPacketsCounterChanged(const quint64 tx);
     void rxInvalidPacketsCounterChanged(const quint64 rx);
+    void rxBudgetDroppedCounterChanged(const quint64 rx);
+    // Multicast datagrams sent, and writes on multicast tx sockets to send them
+    void txMulticastCounterChanged(const quint64 txPackets, const quint64 txWrites);
+    void cacheStatisticsChanged(const netudp::DatagramPoolStatistics statistics);
 
 private:
     std::unique_ptr<WorkerPrivate> _p;
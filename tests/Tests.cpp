@@ -1,13 +1,26 @@
 // ────── INCLUDE ───────
 
 #include <NetUdp/NetUdp.hpp>
+#include <NetUdp/InterfacesMonitor.hpp>
+#include <NetUdp/InterfacesProvider.hpp>
+#include <NetUdp/MulticastTxSocketPool.hpp>
+#include <NetUdp/NativeSocket.hpp>
 #include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QPointer>
+#include <QtCore/QThread>
 #include <QtCore/QCoreApplication>
+#include <QtNetwork/QHostAddress>
+#include <QtNetwork/QNetworkInterface>
 #include <QtTest/QTest>
 #include <QtTest/QSignalSpy>
 #include <gtest/gtest.h>
+#include <atomic>
 #include <string>
 #include <cstring>
+#include <thread>
+#include <memory>
+#include <vector>
 
 namespace netudp {
 
@@ -86,6 +99,447 @@ TEST_F(UnicastClientServer, clientToServerMultithread)
     clientToServerTest();
 }
 
+TEST_F(UnicastClientServer, clientToServerScatterGather)
+{
+    serverListeningPort = 1115;
+    init();
+    rx.setUseWorkerThread(true);
+    tx.setUseWorkerThread(true);
+
+    QSignalSpy spy(&rx, &Socket::sharedDatagramReceived);
+
+    start();
+
+    const std::string header = "Header|";
+    auto payload = tx.makeDatagram(7);
+    std::memcpy(payload->buffer(), "Payload", 7);
+
+    ASSERT_TRUE(tx.sendDatagramV({ConstBuffer(header.c_str(), header.length()), ConstBuffer::fromDatagram(payload)},
+        serverListeningAddr,
+        serverListeningPort));
+
+    if(spy.empty())
+        ASSERT_TRUE(spy.wait(5000));
+
+    const auto arguments = spy.takeFirst();
+    ASSERT_FALSE(arguments.isEmpty());
+    const auto datagram = qvariant_cast<netudp::SharedDatagram>(arguments.at(0));
+    ASSERT_NE(datagram, nullptr);
+
+    const std::string receivedString(reinterpret_cast<const char*>(datagram->buffer()), datagram->length());
+    ASSERT_EQ(receivedString, "Header|Payload");
+}
+
+TEST_F(UnicastClientServer, clientToServerByteArray)
+{
+    serverListeningPort = 1116;
+    init();
+    rx.setUseWorkerThread(true);
+    tx.setUseWorkerThread(true);
+
+    QSignalSpy spy(&rx, &Socket::sharedDatagramReceived);
+
+    start();
+
+    const QByteArray sentData("My QByteArray datagram packet");
+    ASSERT_TRUE(tx.sendDatagram(sentData, serverListeningAddr, serverListeningPort));
+
+    if(spy.empty())
+        ASSERT_TRUE(spy.wait(5000));
+
+    const auto arguments = spy.takeFirst();
+    ASSERT_FALSE(arguments.isEmpty());
+    const auto datagram = qvariant_cast<netudp::SharedDatagram>(arguments.at(0));
+    ASSERT_NE(datagram, nullptr);
+
+    const QByteArray receivedData(reinterpret_cast<const char*>(datagram->buffer()), int(datagram->length()));
+    ASSERT_EQ(receivedData, sentData);
+}
+
+TEST(ByteArrayDatagram, adoptWithoutCopy)
+{
+    const QByteArray data("Implicitly shared payload");
+    const ByteArrayDatagram datagram(data);
+
+    // Same storage, only the reference counter was incremented
+    ASSERT_EQ(reinterpret_cast<const char*>(datagram.buffer()), data.constData());
+    ASSERT_EQ(datagram.length(), std::size_t(data.size()));
+}
+
+TEST(DatagramPool, recycleFromAnotherThread)
+{
+    DatagramPool pool;
+
+    auto datagram = pool.make(1400);
+    const auto* const buffer = datagram->buffer();
+
+    // Last reference released by another thread, the block goes back to the pool return stack
+    std::thread releaser([d = std::move(datagram)]() mutable { d.reset(); });
+    releaser.join();
+
+    datagram = pool.make(1000);
+    ASSERT_EQ(datagram->buffer(), buffer);
+    ASSERT_EQ(datagram->length(), std::size_t(1000));
+}
+
+TEST(DatagramPool, outlivePool)
+{
+    std::shared_ptr<InlineDatagram> datagram;
+    {
+        DatagramPool pool;
+        datagram = pool.make(100);
+    }
+    // The block is freed by its last owner
+    datagram->buffer()[0] = 1;
+    datagram.reset();
+}
+
+TEST(DatagramPool, sizeClasses)
+{
+    DatagramPool pool;
+
+    auto big = pool.make(60000);
+    ASSERT_EQ(big->capacity(), DatagramPool::capacity(DatagramPool::Max));
+    const auto* const bigBuffer = big->buffer();
+    big.reset();
+
+    // A small datagram never reuse a big buffer
+    const auto small = pool.make(40);
+    ASSERT_EQ(small->capacity(), DatagramPool::capacity(DatagramPool::Small));
+    ASSERT_NE(small->buffer(), bigBuffer);
+    ASSERT_EQ(pool.freeCount(DatagramPool::Max), std::size_t(1));
+
+    big = pool.make(20000);
+    ASSERT_EQ(big->buffer(), bigBuffer);
+    ASSERT_EQ(DatagramPool::sizeClass(1500), DatagramPool::Mtu);
+}
+
+TEST(DatagramPool, prewarm)
+{
+    DatagramPool pool(8);
+    pool.setHugePages(DatagramPool::TransparentHugePages);
+
+    // Bounded by the size of the class
+    ASSERT_EQ(pool.prewarm(DatagramPool::Mtu, 100), std::size_t(8));
+    ASSERT_EQ(pool.freeCount(DatagramPool::Mtu), std::size_t(8));
+    ASSERT_EQ(pool.prewarm(DatagramPool::Mtu, 100), std::size_t(0));
+
+    // Served from the arena
+    auto datagram = pool.make(1400);
+    ASSERT_EQ(pool.freeCount(DatagramPool::Mtu), std::size_t(7));
+    std::memset(datagram->buffer(), 0, datagram->length());
+
+    // Only the missing datagrams of every class are allocated
+    ASSERT_EQ(pool.prewarm(2), std::size_t(2 * (DatagramPool::SizeClassCount - 1)));
+    ASSERT_EQ(pool.freeCount(DatagramPool::Small), std::size_t(2));
+}
+
+TEST(DatagramPool, statistics)
+{
+    DatagramPool pool;
+
+    auto first = pool.make(100);
+    auto second = pool.make(100);
+    auto statistics = pool.statistics();
+    ASSERT_EQ(statistics.misses, quint64(2));
+    ASSERT_EQ(statistics.hits, quint64(0));
+    ASSERT_EQ(statistics.inUse, quint64(2));
+
+    first.reset();
+    second.reset();
+    const auto third = pool.make(10);
+
+    statistics = pool.statistics(DatagramPool::Small);
+    ASSERT_EQ(statistics.hits, quint64(1));
+    ASSERT_EQ(statistics.releases, quint64(2));
+    ASSERT_EQ(statistics.inUse, quint64(1));
+    ASSERT_EQ(statistics.free, quint64(1));
+    ASSERT_EQ(statistics.peakInUse, quint64(2));
+    ASSERT_GT(statistics.bytesReserved, quint64(2 * DatagramPool::capacity(DatagramPool::Small)));
+}
+
+TEST(DatagramPool, adaptiveSize)
+{
+    DatagramPool pool(4);
+
+    DatagramPoolAdaptivePolicy policy;
+    policy.enabled = true;
+    policy.idleTimeout = 2000;
+    policy.minimumSize = 2;
+    pool.setAdaptivePolicy(policy);
+
+    // Grow to the burst
+    std::vector<SharedDatagram> burst;
+    for(int i = 0; i < 50; ++i)
+        burst.push_back(pool.make(100));
+    pool.adapt(1000);
+    auto statistics = pool.statistics(DatagramPool::Small);
+    ASSERT_EQ(statistics.size, quint64(50));
+    ASSERT_EQ(statistics.grows, quint64(1));
+
+    // The whole burst is kept for the next one
+    burst.clear();
+    burst.push_back(pool.make(100));
+    ASSERT_EQ(pool.statistics(DatagramPool::Small).hits, quint64(1));
+    burst.clear();
+
+    // Decay once a whole idle period stayed below the size
+    for(int i = 0; i < 4; ++i)
+        pool.adapt(1000);
+    statistics = pool.statistics(DatagramPool::Small);
+    ASSERT_EQ(statistics.size, quint64(2));
+    ASSERT_EQ(statistics.shrinks, quint64(1));
+    ASSERT_LE(pool.freeCount(DatagramPool::Small), std::size_t(2));
+}
+
+TEST(RxMemoryBudget, weightedAdmission)
+{
+    DatagramPool pool;
+    RxMemoryBudget budget;
+    const auto capacity = DatagramPool::capacity(DatagramPool::Small);
+
+    // Disabled budget doesn't account anything
+    auto free = pool.make(100);
+    ASSERT_TRUE(free->acquireBudget(budget, 1));
+    ASSERT_EQ(budget.used(), quint64(0));
+
+    budget.setCapacity(4 * capacity);
+    auto first = pool.make(100);
+    auto second = pool.make(100);
+    ASSERT_TRUE(first->acquireBudget(budget, 1));
+    ASSERT_TRUE(second->acquireBudget(budget, 1));
+    ASSERT_EQ(budget.used(), quint64(2 * capacity));
+
+    // Low weight socket drop first, while a high weight one still receive
+    auto low = pool.make(100);
+    ASSERT_FALSE(low->acquireBudget(budget, 0.5));
+    ASSERT_TRUE(low->acquireBudget(budget, 1));
+    ASSERT_EQ(budget.used(), quint64(3 * capacity));
+
+    // Releasing the datagram give back its bytes
+    first.reset();
+    second.reset();
+    ASSERT_EQ(budget.used(), quint64(capacity));
+    auto next = pool.make(100);
+    ASSERT_TRUE(next->acquireBudget(budget, 0.5));
+    low.reset();
+    next.reset();
+    ASSERT_EQ(budget.used(), quint64(0));
+}
+
+TEST(RxMemoryBudget, fixedDatagramPool)
+{
+    FixedDatagramPool<1500> pool(1);
+    RxMemoryBudget budget;
+    budget.setCapacity(2 * 1500);
+
+    // Charged by capacity, not by length
+    auto datagram = pool.make(100);
+    ASSERT_TRUE(datagram->acquireBudget(budget, 1));
+    ASSERT_EQ(budget.used(), quint64(1500));
+
+    // The pool keep the memory, so the datagram stay charged until it is reused
+    datagram.reset();
+    ASSERT_EQ(budget.used(), quint64(1500));
+    datagram = pool.make(100);
+    ASSERT_EQ(budget.used(), quint64(0));
+    ASSERT_TRUE(datagram->acquireBudget(budget, 1));
+    ASSERT_EQ(budget.used(), quint64(1500));
+}
+
+TEST(DatagramSlice, shareParentBuffer)
+{
+    DatagramPool pool;
+    SharedDatagram parent = pool.make(10);
+    std::memcpy(parent->buffer(), "0123456789", 10);
+    parent->senderPort = 1234;
+
+    const auto slice = DatagramSlice::make(parent, 2, 5);
+    ASSERT_EQ(slice->buffer(), parent->buffer() + 2);
+    ASSERT_EQ(slice->length(), std::size_t(5));
+    ASSERT_EQ(slice->senderPort, 1234);
+
+    // A slice of a slice reference the parent directly, and is clamped to the slice
+    const auto subSlice = DatagramSlice::make(slice, 1, 10);
+    ASSERT_EQ(subSlice->parent(), parent);
+    ASSERT_EQ(subSlice->offset(), std::size_t(3));
+    ASSERT_EQ(subSlice->length(), std::size_t(4));
+
+    // The parent is kept alive by its slices
+    parent.reset();
+    ASSERT_EQ(std::memcmp(subSlice->buffer(), "3456", 4), 0);
+}
+
+class TestInterface : public IInterface
+{
+public:
+    TestInterface(const QString& name, int index)
+        : _name(name)
+        , _index(index)
+    {
+    }
+
+    bool isValid() const override
+    {
+        return true;
+    }
+    QString name() const override
+    {
+        return _name;
+    }
+    bool isUp() const override
+    {
+        return true;
+    }
+    bool isRunning() const override
+    {
+        return true;
+    }
+    bool canBroadcast() const override
+    {
+        return false;
+    }
+    bool isLoopBack() const override
+    {
+        return false;
+    }
+    bool isPointToPoint() const override
+    {
+        return false;
+    }
+    bool canMulticast() const override
+    {
+        return true;
+    }
+    int index() const override
+    {
+        return _index;
+    }
+
+private:
+    QString _name;
+    int _index;
+};
+
+TEST(InterfacesSnapshot, indexByNameAndIndex)
+{
+    const InterfacesSnapshot snapshot(
+        {std::make_shared<TestInterface>(QStringLiteral("eth0"), 2), std::make_shared<TestInterface>(QStringLiteral("eth1"), 3)}, 7);
+
+    ASSERT_EQ(snapshot.generation(), quint64(7));
+    ASSERT_EQ(snapshot.interfaces().size(), std::size_t(2));
+    ASSERT_EQ(snapshot.fromName(QStringLiteral("eth1"))->index(), 3);
+    ASSERT_EQ(snapshot.fromIndex(2)->name(), QStringLiteral("eth0"));
+    ASSERT_EQ(snapshot.fromName(QStringLiteral("wlan0")), nullptr);
+    ASSERT_EQ(snapshot.fromIndex(4), nullptr);
+
+    // Generation only change with the interfaces
+    const auto first = InterfacesProvider::snapshot(false);
+    const auto second = InterfacesProvider::snapshot(false);
+    ASSERT_EQ(first->generation(), second->generation());
+}
+
+TEST(InterfacesProvider, concurrentSnapshots)
+{
+    std::atomic<bool> failed = {false};
+    std::vector<std::thread> readers;
+    for(int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back(
+            [&failed]()
+            {
+                for(int j = 0; j < 1000; ++j)
+                {
+                    const auto snapshot = InterfacesProvider::snapshot();
+                    if(!snapshot || snapshot->generation() == 0)
+                        failed = true;
+                }
+            });
+    }
+
+    for(int i = 0; i < 20; ++i)
+    {
+        InterfacesProvider::invalidateCache();
+        std::this_thread::yield();
+    }
+
+    for(auto& reader: readers)
+        reader.join();
+    ASSERT_FALSE(failed);
+}
+
+TEST(InterfacesMonitor, sharedInstance)
+{
+    auto* const monitor = InterfacesMonitor::instance();
+    ASSERT_NE(monitor, nullptr);
+    ASSERT_EQ(monitor, InterfacesMonitor::instance());
+
+#ifdef Q_OS_LINUX
+    // The netlink socket is opened from the application event loop
+    QCoreApplication::processEvents();
+    ASSERT_TRUE(monitor->isActive());
+#endif
+}
+
+TEST(FixedDatagram, poolRecycle)
+{
+    FixedDatagramPool<1500> pool(1);
+
+    auto datagram = pool.make(100);
+    ASSERT_EQ(datagram->length(), std::size_t(100));
+    const auto* const buffer = datagram->buffer();
+    datagram.reset();
+
+    // The only datagram is free again, it is reused
+    datagram = pool.make(1500);
+    ASSERT_EQ(datagram->buffer(), buffer);
+    ASSERT_EQ(datagram->length(), std::size_t(1500));
+
+    // The pool is full, a new datagram is made but not kept
+    const auto other = pool.make(10);
+    ASSERT_NE(other->buffer(), buffer);
+
+    // Never truncate a datagram that doesn't fit
+    ASSERT_EQ(pool.make(1501), nullptr);
+}
+
+TEST(FixedDatagramSocket, clientToServer)
+{
+    const QString address = QStringLiteral("127.0.0.1");
+    const quint16 port = 1117;
+
+    FixedDatagramSocket<1500> rx;
+    FixedDatagramSocket<1500> tx;
+    rx.setRxAddress(address);
+    rx.setRxPort(port);
+    rx.setUseWorkerThread(true);
+    tx.setUseWorkerThread(true);
+
+    QSignalSpy spyBounded(&rx, &Socket::isBoundedChanged);
+    QSignalSpy spy(&rx, &Socket::sharedDatagramReceived);
+
+    rx.start();
+    tx.start();
+    if(!rx.isBounded())
+        ASSERT_TRUE(spyBounded.wait(5000));
+
+    const std::string sentString = "My fixed datagram packet";
+    auto sent = tx.makeFixedDatagram(sentString.length());
+    std::memcpy(sent->buffer(), sentString.c_str(), sentString.length());
+    ASSERT_TRUE(tx.sendDatagram(std::move(sent), address, port));
+
+    if(spy.empty())
+        ASSERT_TRUE(spy.wait(5000));
+
+    const auto arguments = spy.takeFirst();
+    ASSERT_FALSE(arguments.isEmpty());
+    const auto datagram = qvariant_cast<netudp::SharedDatagram>(arguments.at(0));
+    ASSERT_NE(std::dynamic_pointer_cast<FixedDatagram<1500>>(datagram), nullptr);
+
+    const std::string receivedString(reinterpret_cast<const char*>(datagram->buffer()), datagram->length());
+    ASSERT_EQ(receivedString, sentString);
+}
+
 // Server send multicast data to client
 class MulticastClientServer : public ::testing::Test
 {
@@ -169,6 +623,499 @@ TEST_F(MulticastClientServer, Async)
     serverToClientTest();
 }
 
+TEST(MulticastGroups, differentialUpdate)
+{
+    netudp::Socket socket;
+    QSignalSpy spy(&socket, &Socket::multicastGroupsChanged);
+    QSignalSpy spyUpdate(&socket, &Socket::updateMulticastGroupsWorker);
+
+    socket.setMulticastGroups({QStringLiteral("239.1.4.1"), QStringLiteral("239.1.4.2"), QStringLiteral("not a group")});
+    ASSERT_EQ(spy.count(), 1);
+    ASSERT_EQ(spyUpdate.count(), 1);
+    ASSERT_EQ(socket.multicastGroups(), QStringList({QStringLiteral("239.1.4.1"), QStringLiteral("239.1.4.2")}));
+
+    // Only the difference is sent to the worker
+    socket.setMulticastGroups({QStringLiteral("239.1.4.2"), QStringLiteral("239.1.4.3")});
+    ASSERT_EQ(spy.count(), 2);
+    ASSERT_EQ(spyUpdate.count(), 2);
+    const auto arguments = spyUpdate.takeLast();
+    ASSERT_EQ(arguments.at(0).toStringList(), QStringList({QStringLiteral("239.1.4.3")}));
+    ASSERT_EQ(arguments.at(1).toStringList(), QStringList({QStringLiteral("239.1.4.1")}));
+
+    // Same groups, nothing to do
+    socket.setMulticastGroups({QStringLiteral("239.1.4.3"), QStringLiteral("239.1.4.2")});
+    ASSERT_EQ(spy.count(), 2);
+    ASSERT_EQ(spyUpdate.count(), 2);
+}
+
+TEST(Reconfiguration, makeBeforeBreak)
+{
+    netudp::Socket rx;
+    netudp::Socket tx;
+
+    QSignalSpy spyRxBounded(&rx, &Socket::isBoundedChanged);
+    rx.start(QStringLiteral("127.0.0.1"), 11280);
+    if(!rx.isBounded())
+        ASSERT_TRUE(spyRxBounded.wait(5000));
+    spyRxBounded.clear();
+
+    // Both changes are applied at once, and the socket is never unbounded
+    rx.beginReconfiguration();
+    rx.setRxPort(11281);
+    rx.setSeparateRxTxSockets(true);
+    rx.endReconfiguration();
+    QTest::qWait(100);
+    ASSERT_EQ(spyRxBounded.count(), 0);
+    ASSERT_TRUE(rx.isBounded());
+
+    QSignalSpy spyTxBounded(&tx, &Socket::isBoundedChanged);
+    tx.start();
+    if(!tx.isBounded())
+        ASSERT_TRUE(spyTxBounded.wait(5000));
+
+    QSignalSpy spyReceived(&rx, &Socket::sharedDatagramReceived);
+    const std::string sentString = "Reconfigured datagram";
+    tx.sendDatagram(sentString.c_str(), sentString.length(), QStringLiteral("127.0.0.1"), 11281);
+    ASSERT_TRUE(spyReceived.wait(5000));
+
+    // Output only socket is reported bounded, without emitting it again
+    spyRxBounded.clear();
+    rx.setInputEnabled(false);
+    QTest::qWait(100);
+    ASSERT_EQ(spyRxBounded.count(), 0);
+    ASSERT_TRUE(rx.isBounded());
+}
+
+TEST(Reconfiguration, keepMemberships)
+{
+    const auto group = QStringLiteral("239.1.8.1");
+    const quint16 port = 11282;
+
+    netudp::Socket rx;
+    netudp::Socket tx;
+    rx.setMulticastGroups({group});
+    rx.setMulticastLoopback(true);
+    tx.setMulticastLoopback(true);
+
+    QSignalSpy spyRxBounded(&rx, &Socket::isBoundedChanged);
+    QSignalSpy spyTxBounded(&tx, &Socket::isBoundedChanged);
+    rx.start(port);
+    tx.start();
+    if(!rx.isBounded())
+        ASSERT_TRUE(spyRxBounded.wait(5000));
+    if(!tx.isBounded())
+        ASSERT_TRUE(spyTxBounded.wait(5000));
+
+    // New sockets join the groups of the previous ones
+    rx.setSeparateRxTxSockets(true);
+    // Wait one second to be sure subscription succeed
+    QTest::qWait(1000);
+    ASSERT_TRUE(rx.isMulticastGroupPresent(group));
+
+    QSignalSpy spyReceived(&rx, &Socket::sharedDatagramReceived);
+    const std::string sentString = "Multicast after reconfiguration";
+    tx.sendDatagram(sentString.c_str(), sentString.length(), group, port);
+    if(spyReceived.empty())
+        ASSERT_TRUE(spyReceived.wait(5000));
+
+    const auto datagram = qvariant_cast<netudp::SharedDatagram>(spyReceived.takeFirst().at(0));
+    ASSERT_NE(datagram, nullptr);
+    const std::string receivedString(reinterpret_cast<const char*>(datagram->buffer()), datagram->length());
+    ASSERT_EQ(receivedString, sentString);
+}
+
+TEST(MulticastSource, filterLists)
+{
+    netudp::Socket socket;
+    const auto ssmGroup = QStringLiteral("232.1.1.1");
+    const auto asmGroup = QStringLiteral("239.1.6.1");
+
+    // Include list, group is joined with the first source and left with the last one
+    ASSERT_TRUE(socket.joinMulticastGroup(ssmGroup, QStringLiteral("10.0.0.1")));
+    ASSERT_TRUE(socket.joinMulticastGroup(ssmGroup, QStringLiteral("10.0.0.2")));
+    ASSERT_FALSE(socket.joinMulticastGroup(ssmGroup, QStringLiteral("10.0.0.2")));
+    ASSERT_FALSE(socket.joinMulticastGroup(ssmGroup, QStringLiteral("239.0.0.1")));
+    ASSERT_FALSE(socket.joinMulticastGroup(ssmGroup, QStringLiteral("::1")));
+    ASSERT_TRUE(socket.isMulticastGroupPresent(ssmGroup));
+    ASSERT_EQ(socket.multicastSources(ssmGroup), QStringList({QStringLiteral("10.0.0.1"), QStringLiteral("10.0.0.2")}));
+    ASSERT_FALSE(socket.blockMulticastSource(ssmGroup, QStringLiteral("10.0.0.3")));
+
+    ASSERT_TRUE(socket.leaveMulticastGroup(ssmGroup, QStringLiteral("10.0.0.1")));
+    ASSERT_TRUE(socket.isMulticastGroupPresent(ssmGroup));
+    ASSERT_TRUE(socket.leaveMulticastGroup(ssmGroup, QStringLiteral("10.0.0.2")));
+    ASSERT_FALSE(socket.isMulticastGroupPresent(ssmGroup));
+    ASSERT_TRUE(socket.multicastSources(ssmGroup).isEmpty());
+
+    // Exclude list, only on groups joined for any source
+    ASSERT_FALSE(socket.blockMulticastSource(asmGroup, QStringLiteral("10.0.0.1")));
+    ASSERT_TRUE(socket.joinMulticastGroup(asmGroup));
+    ASSERT_FALSE(socket.joinMulticastGroup(asmGroup, QStringLiteral("10.0.0.1")));
+    ASSERT_TRUE(socket.blockMulticastSource(asmGroup, QStringLiteral("10.0.0.1")));
+    ASSERT_EQ(socket.blockedMulticastSources(asmGroup), QStringList({QStringLiteral("10.0.0.1")}));
+    ASSERT_TRUE(socket.unblockMulticastSource(asmGroup, QStringLiteral("10.0.0.1")));
+    ASSERT_TRUE(socket.isMulticastGroupPresent(asmGroup));
+    ASSERT_TRUE(socket.blockMulticastSource(asmGroup, QStringLiteral("10.0.0.1")));
+    ASSERT_TRUE(socket.leaveMulticastGroup(asmGroup));
+    ASSERT_TRUE(socket.blockedMulticastSources(asmGroup).isEmpty());
+}
+
+#ifdef Q_OS_LINUX
+// Datagrams sent on lo come from 127.0.0.1, filters are updated while the groups are joined
+TEST(MulticastSource, kernelFiltering)
+{
+    const quint16 multicastPort = 11290;
+    const auto asmGroup = QStringLiteral("239.1.9.1");
+    const auto ssmGroup = QStringLiteral("239.1.9.2");
+    const auto loopbackSource = QStringLiteral("127.0.0.1");
+    const auto otherSource = QStringLiteral("127.0.0.2");
+
+    netudp::Socket tx;
+    netudp::Socket rx;
+    rx.setRxPort(multicastPort);
+    rx.setMulticastListeningInterfaces({QStringLiteral("lo")});
+    tx.setMulticastOutgoingInterfaces({QStringLiteral("lo")});
+    tx.setMulticastLoopback(true);
+    rx.setMulticastLoopback(true);
+    ASSERT_TRUE(rx.joinMulticastGroup(asmGroup));
+    ASSERT_TRUE(rx.joinMulticastGroup(ssmGroup, otherSource));
+
+    QSignalSpy spyTxBounded(&tx, &Socket::isBoundedChanged);
+    QSignalSpy spyRxBounded(&rx, &Socket::isBoundedChanged);
+    QSignalSpy spy(&rx, &Socket::sharedDatagramReceived);
+
+    tx.start();
+    rx.start();
+
+    if(!tx.isBounded())
+        ASSERT_TRUE(spyTxBounded.wait(5000));
+    if(!rx.isBounded())
+        ASSERT_TRUE(spyRxBounded.wait(5000));
+
+    // Wait one second to be sure subscription succeed
+    QTest::qWait(1000);
+
+    const std::string sentString = "Filtered by source";
+    const auto receivedCount = [&](const QString& group)
+    {
+        spy.clear();
+        tx.sendDatagram(sentString.c_str(), sentString.length(), group, multicastPort);
+        QTest::qWait(500);
+        return spy.count();
+    };
+
+    // Any source
+    ASSERT_EQ(receivedCount(asmGroup), 1);
+    ASSERT_TRUE(rx.blockMulticastSource(asmGroup, loopbackSource));
+    QTest::qWait(200);
+    ASSERT_EQ(receivedCount(asmGroup), 0);
+    ASSERT_TRUE(rx.unblockMulticastSource(asmGroup, loopbackSource));
+    QTest::qWait(200);
+    ASSERT_EQ(receivedCount(asmGroup), 1);
+
+    // Source specific
+    ASSERT_EQ(receivedCount(ssmGroup), 0);
+    ASSERT_TRUE(rx.joinMulticastGroup(ssmGroup, loopbackSource));
+    QTest::qWait(200);
+    ASSERT_EQ(receivedCount(ssmGroup), 1);
+    ASSERT_TRUE(rx.leaveMulticastGroup(ssmGroup, otherSource));
+    QTest::qWait(200);
+    ASSERT_EQ(receivedCount(ssmGroup), 1);
+    ASSERT_TRUE(rx.leaveMulticastGroup(ssmGroup, loopbackSource));
+    QTest::qWait(200);
+    ASSERT_EQ(receivedCount(ssmGroup), 0);
+}
+#endif
+
+#ifdef Q_OS_LINUX
+// Shards rely on IP_MULTICAST_ALL to only read their own groups
+TEST(MulticastShard, manyGroups)
+{
+    const quint16 multicastPort = 11120;
+    QStringList groups;
+    for(int i = 1; i <= 45; ++i)
+        groups.append(QStringLiteral("239.1.3.%1").arg(i));
+
+    netudp::Socket tx;
+    netudp::Socket rx;
+    rx.setMulticastGroups(groups);
+    rx.setRxPort(multicastPort);
+    rx.setMulticastMembershipsPerSocket(8);
+    tx.setMulticastLoopback(true);
+    rx.setMulticastLoopback(true);
+
+    QSignalSpy spyTxBounded(&tx, &Socket::isBoundedChanged);
+    QSignalSpy spyRxBounded(&rx, &Socket::isBoundedChanged);
+    QSignalSpy spy(&rx, &Socket::sharedDatagramReceived);
+
+    tx.start();
+    rx.start();
+
+    if(!tx.isBounded())
+        ASSERT_TRUE(spyTxBounded.wait(5000));
+    if(!rx.isBounded())
+        ASSERT_TRUE(spyRxBounded.wait(5000));
+
+    // Wait one second to be sure subscription succeed
+    QTest::qWait(1000);
+
+    // Last group is joined on the last shard, it must be received exactly once
+    const std::string sentString = "Sharded multicast datagram";
+    tx.sendDatagram(sentString.c_str(), sentString.length(), groups.back(), multicastPort);
+
+    if(spy.empty())
+        ASSERT_TRUE(spy.wait(5000));
+    QTest::qWait(200);
+    ASSERT_EQ(spy.count(), 1);
+
+    const auto datagram = qvariant_cast<netudp::SharedDatagram>(spy.takeFirst().at(0));
+    ASSERT_NE(datagram, nullptr);
+    const std::string receivedString(reinterpret_cast<const char*>(datagram->buffer()), datagram->length());
+    ASSERT_EQ(receivedString, sentString);
+}
+
+// Join and leave 5000 groups on lo, spread over 250 rx sockets
+TEST(MulticastShard, fiveThousandGroups)
+{
+    const quint16 multicastPort = 11121;
+    const int groupCount = 5000;
+    QStringList groups;
+    for(int i = 0; i < groupCount; ++i)
+        groups.append(QStringLiteral("239.2.%1.%2").arg(i / 250).arg(i % 250 + 1));
+
+    netudp::Socket tx;
+    netudp::Socket rx;
+    rx.setRxPort(multicastPort);
+    rx.setMulticastListeningInterfaces({QStringLiteral("lo")});
+    tx.setMulticastOutgoingInterfaces({QStringLiteral("lo")});
+    tx.setMulticastLoopback(true);
+    rx.setMulticastLoopback(true);
+
+    QSignalSpy spyTxBounded(&tx, &Socket::isBoundedChanged);
+    QSignalSpy spyRxBounded(&rx, &Socket::isBoundedChanged);
+    QSignalSpy spyJoined(&rx, &Socket::multicastGroupJoined);
+    QSignalSpy spyLeaved(&rx, &Socket::multicastGroupLeaved);
+    QSignalSpy spy(&rx, &Socket::sharedDatagramReceived);
+
+    tx.start();
+    rx.start();
+
+    if(!tx.isBounded())
+        ASSERT_TRUE(spyTxBounded.wait(5000));
+    if(!rx.isBounded())
+        ASSERT_TRUE(spyRxBounded.wait(5000));
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    rx.setMulticastGroups(groups);
+    while(spyJoined.count() < groupCount && elapsed.elapsed() < 10000)
+        QTest::qWait(10);
+    ASSERT_EQ(spyJoined.count(), groupCount);
+    const auto joinElapsed = elapsed.elapsed();
+
+    const std::string sentString = "One of many groups";
+    tx.sendDatagram(sentString.c_str(), sentString.length(), groups.back(), multicastPort);
+    if(spy.empty())
+        ASSERT_TRUE(spy.wait(5000));
+    QTest::qWait(200);
+    ASSERT_EQ(spy.count(), 1);
+
+    elapsed.restart();
+    rx.setMulticastGroups({});
+    while(spyLeaved.count() < groupCount && elapsed.elapsed() < 10000)
+        QTest::qWait(10);
+    ASSERT_EQ(spyLeaved.count(), groupCount);
+
+    qDebug() << "Join" << groupCount << "groups in" << joinElapsed << "ms, leave them in" << elapsed.elapsed() << "ms";
+}
+
+// Two receivers on the same port join different groups, each one must only receive its own group
+class MulticastStrictFiltering : public ::testing::Test
+{
+protected:
+    quint16 multicastPort = 11250;
+    QString groupA = QStringLiteral("239.1.5.1");
+    QString groupB = QStringLiteral("239.1.5.2");
+
+    netudp::Socket tx;
+    netudp::Socket rxA;
+    netudp::Socket rxB;
+
+    void strictFilteringTest()
+    {
+        rxA.setRxPort(multicastPort);
+        rxA.setMulticastGroups({groupA});
+        rxB.setRxPort(multicastPort);
+        rxB.setMulticastGroups({groupB});
+        tx.setMulticastLoopback(true);
+        rxA.setMulticastLoopback(true);
+        rxB.setMulticastLoopback(true);
+
+        QSignalSpy spyTxBounded(&tx, &Socket::isBoundedChanged);
+        QSignalSpy spyRxABounded(&rxA, &Socket::isBoundedChanged);
+        QSignalSpy spyRxBBounded(&rxB, &Socket::isBoundedChanged);
+        QSignalSpy spyA(&rxA, &Socket::sharedDatagramReceived);
+        QSignalSpy spyB(&rxB, &Socket::sharedDatagramReceived);
+
+        tx.start();
+        rxA.start();
+        rxB.start();
+
+        if(!tx.isBounded())
+            ASSERT_TRUE(spyTxBounded.wait(5000));
+        if(!rxA.isBounded())
+            ASSERT_TRUE(spyRxABounded.wait(5000));
+        if(!rxB.isBounded())
+            ASSERT_TRUE(spyRxBBounded.wait(5000));
+
+        // Wait one second to be sure subscription succeed
+        QTest::qWait(1000);
+
+        const std::string sentString = "Only for B";
+        tx.sendDatagram(sentString.c_str(), sentString.length(), groupB, multicastPort);
+
+        if(spyB.empty())
+            ASSERT_TRUE(spyB.wait(5000));
+        QTest::qWait(200);
+
+        ASSERT_EQ(spyB.count(), 1);
+        ASSERT_EQ(spyA.count(), 0);
+    }
+};
+
+TEST_F(MulticastStrictFiltering, ipMulticastAll)
+{
+    rxA.setMulticastStrictFiltering(true);
+    rxB.setMulticastStrictFiltering(true);
+    strictFilteringTest();
+}
+
+TEST_F(MulticastStrictFiltering, groupSockets)
+{
+    multicastPort = 11251;
+    rxA.setMulticastGroupSockets(true);
+    rxB.setMulticastGroupSockets(true);
+    strictFilteringTest();
+}
+#endif
+
+TEST(MulticastTxSocketPool, shareSockets)
+{
+    const auto socketsBefore = MulticastTxSocketPool::socketCount();
+    const auto borrowersBefore = MulticastTxSocketPool::borrowerCount();
+
+    {
+        netudp::Socket tx1;
+        netudp::Socket tx2;
+        tx1.setMulticastLoopback(true);
+        tx2.setMulticastLoopback(true);
+
+        QSignalSpy spyTx1Bounded(&tx1, &Socket::isBoundedChanged);
+        QSignalSpy spyTx2Bounded(&tx2, &Socket::isBoundedChanged);
+        tx1.start();
+        tx2.start();
+        if(!tx1.isBounded())
+            ASSERT_TRUE(spyTx1Bounded.wait(5000));
+        if(!tx2.isBounded())
+            ASSERT_TRUE(spyTx2Bounded.wait(5000));
+
+        const std::string sentString = "Pooled multicast datagram";
+        tx1.sendDatagram(sentString.c_str(), sentString.length(), QStringLiteral("239.1.7.1"), 11260);
+        tx2.sendDatagram(sentString.c_str(), sentString.length(), QStringLiteral("239.1.7.1"), 11260);
+        QTest::qWait(100);
+
+        // Both sockets send on the same ifaces, with the same ttl and loopback
+        const auto sockets = MulticastTxSocketPool::socketCount() - socketsBefore;
+        ASSERT_GT(sockets, std::size_t(0));
+        ASSERT_EQ(MulticastTxSocketPool::borrowerCount() - borrowersBefore, 2 * sockets);
+
+        tx1.stop();
+        tx2.stop();
+        QTest::qWait(100);
+    }
+
+    ASSERT_EQ(MulticastTxSocketPool::socketCount(), socketsBefore);
+    ASSERT_EQ(MulticastTxSocketPool::borrowerCount(), borrowersBefore);
+}
+
+TEST(MulticastTxSocketPool, keyedByIndex)
+{
+    int loopbackIndex = 0;
+    for(const auto& iface: QNetworkInterface::allInterfaces())
+    {
+        if(iface.flags() & QNetworkInterface::IsLoopBack)
+            loopbackIndex = iface.index();
+    }
+    ASSERT_NE(loopbackIndex, 0);
+
+    // Same name with another os index, as an iface removed and added again
+    const auto socketsBefore = MulticastTxSocketPool::socketCount();
+    const TestInterface iface(QStringLiteral("netudp0"), 0);
+    const TestInterface recreated(QStringLiteral("netudp0"), loopbackIndex);
+
+    const auto descriptor = MulticastTxSocketPool::acquire(iface, 1, true);
+    const auto recreatedDescriptor = MulticastTxSocketPool::acquire(recreated, 1, true);
+    ASSERT_NE(descriptor, -1);
+    ASSERT_NE(recreatedDescriptor, -1);
+    ASSERT_NE(descriptor, recreatedDescriptor);
+    ASSERT_EQ(MulticastTxSocketPool::socketCount(), socketsBefore + 2);
+
+    MulticastTxSocketPool::release(iface.name(), iface.index(), 1, true);
+    MulticastTxSocketPool::release(recreated.name(), recreated.index(), 1, true);
+    ASSERT_EQ(MulticastTxSocketPool::socketCount(), socketsBefore);
+}
+
+TEST(MulticastEgress, fanOut)
+{
+    netudp::Socket tx;
+    tx.setMulticastLoopback(true);
+    tx.setMulticastEgressPolicy(MulticastEgressPolicy::FirstHealthy);
+
+    const auto group = QStringLiteral("239.1.8.1");
+    ASSERT_FALSE(tx.setMulticastEgressInterfaces(QStringLiteral("127.0.0.1"), {QStringLiteral("lo")}));
+    ASSERT_TRUE(tx.setMulticastEgressInterfaces(QStringLiteral("239.1.8.2"), {QStringLiteral("lo")}));
+    ASSERT_FALSE(tx.setMulticastEgressInterfaces(QStringLiteral("239.1.8.2"), {QStringLiteral("lo")}));
+    ASSERT_EQ(tx.multicastEgressInterfaces(QStringLiteral("239.1.8.2")), QStringList({QStringLiteral("lo")}));
+    ASSERT_TRUE(tx.setMulticastEgressInterfaces(QStringLiteral("239.1.8.2"), {}));
+    ASSERT_TRUE(tx.multicastEgressInterfaces(QStringLiteral("239.1.8.2")).isEmpty());
+
+    QSignalSpy spyBounded(&tx, &Socket::isBoundedChanged);
+    tx.start();
+    if(!tx.isBounded())
+        ASSERT_TRUE(spyBounded.wait(5000));
+
+    QSignalSpy spyWrites(&tx, &Socket::txMulticastWritesTotalChanged);
+    const std::string sentString = "Egress policy datagram";
+    for(int i = 0; i < 4; ++i)
+        tx.sendDatagram(sentString.c_str(), sentString.length(), group, 11270);
+
+    // Counters are reported every second by the worker
+    if(!tx.txMulticastWritesTotal())
+        ASSERT_TRUE(spyWrites.wait(3000));
+    ASSERT_EQ(tx.txMulticastPacketsTotal(), quint64(4));
+    // One healthy iface is enough, others are only tried when a write fail
+    ASSERT_EQ(tx.txMulticastWritesTotal(), quint64(4));
+
+    tx.clearTxCounter();
+    ASSERT_EQ(tx.txMulticastPacketsTotal(), quint64(0));
+    ASSERT_EQ(tx.txMulticastWritesTotal(), quint64(0));
+}
+
+#ifdef Q_OS_LINUX
+TEST(MulticastEgress, routeTable)
+{
+    const auto loopback = QNetworkInterface::interfaceFromName(QStringLiteral("lo"));
+    ASSERT_TRUE(loopback.isValid());
+
+    // The RTM_NEWROUTE reply is parsed for its output interface
+    QString error;
+    ASSERT_EQ(NativeSocket::routeInterfaceIndex(QHostAddress(QStringLiteral("127.0.0.1")), &error), loopback.index());
+    ASSERT_TRUE(error.isEmpty());
+
+    ASSERT_EQ(NativeSocket::routeInterfaceIndex(QHostAddress(), &error), 0);
+    ASSERT_FALSE(error.isEmpty());
+}
+#endif
+
 // Server send multicast data to client
 class MulticastClient2Server : public ::testing::Test
 {
@@ -270,6 +1217,157 @@ TEST_F(MulticastClient2Server, Async)
     serverToClientTest();
 }
 
+TEST(PersistentWorker, keepThreadAcrossRestart)
+{
+    Socket client;
+    client.setUseWorkerThread(true);
+
+    QPointer<QThread> thread;
+    for(int i = 0; i < 3; ++i)
+    {
+        QSignalSpy spyClientBounded(&client, &Socket::isBoundedChanged);
+        client.start(11290);
+        if(!client.isBounded())
+            ASSERT_TRUE(spyClientBounded.wait(1000));
+
+        auto* const workerThread = client.findChild<QThread*>();
+        ASSERT_TRUE(workerThread);
+        if(thread)
+            ASSERT_EQ(thread, workerThread);
+        thread = workerThread;
+
+        client.stop();
+        ASSERT_TRUE(thread->isRunning());
+    }
+
+    // Without persistence the stopped worker and its thread are destroyed
+    client.setPersistentWorker(false);
+    QTest::qWait(10);
+    ASSERT_TRUE(thread.isNull());
+}
+
+TEST(AsyncStop, stoppedSignal)
+{
+    const auto SOCKET_COUNT = 20;
+
+    std::vector<std::unique_ptr<Socket>> sockets;
+    for(int i = 0; i < SOCKET_COUNT; ++i)
+    {
+        auto socket = std::make_unique<Socket>();
+        socket->setUseWorkerThread(true);
+        socket->setPersistentWorker(i % 2 == 0);
+        QSignalSpy spyBounded(socket.get(), &Socket::isBoundedChanged);
+        socket->start(11300 + i);
+        if(!socket->isBounded())
+            ASSERT_TRUE(spyBounded.wait(1000));
+        sockets.push_back(std::move(socket));
+    }
+
+    std::vector<std::unique_ptr<QSignalSpy>> spiesStopped;
+    std::vector<std::unique_ptr<QSignalSpy>> spiesReceived;
+    for(int i = 0; i < SOCKET_COUNT; ++i)
+    {
+        auto& socket = sockets[i];
+        spiesStopped.push_back(std::make_unique<QSignalSpy>(socket.get(), &Socket::stopped));
+        spiesReceived.push_back(std::make_unique<QSignalSpy>(socket.get(), &Socket::sharedDatagramReceived));
+
+        // Sent to itself, may be received by the worker while it's stopping
+        const char data[] = "late";
+        socket->sendDatagram(data, sizeof(data), "127.0.0.1", 11300 + i);
+    }
+
+    // 'stop' doesn't wait for any worker
+    for(auto& socket: sockets)
+    {
+        ASSERT_TRUE(socket->stop());
+        ASSERT_FALSE(socket->isRunning());
+    }
+
+    for(int i = 0; i < SOCKET_COUNT; ++i)
+    {
+        if(spiesStopped[i]->isEmpty())
+            ASSERT_TRUE(spiesStopped[i]->wait(1000));
+        ASSERT_EQ(spiesStopped[i]->count(), 1);
+    }
+
+    // Late datagrams are discarded
+    QTest::qWait(10);
+    for(const auto& spy: spiesReceived)
+        ASSERT_TRUE(spy->isEmpty());
+}
+
+TEST(Watchdog, backoff)
+{
+    Socket socket;
+    socket.setWatchdogPeriod(1000);
+
+    // Not an address of the host, so binding fail at each restart
+    QSignalSpy spyRestarted(&socket, &Socket::watchdogRestarted);
+    socket.start("203.0.113.1", 11310);
+
+    // First restarts are a few ms apart, while a fixed watchdogPeriod would restart once per second
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while(spyRestarted.count() < 4)
+        ASSERT_TRUE(spyRestarted.wait(1000));
+    ASSERT_LT(elapsed.elapsed(), 1000);
+
+    for(const auto& arguments: spyRestarted)
+    {
+        ASSERT_EQ(arguments.at(0).value<netudp::WatchdogComponent>(), netudp::WatchdogComponent::Worker);
+        ASSERT_EQ(arguments.at(3).toString(), QString("Fail to bind"));
+    }
+    ASSERT_GE(socket.watchdogRestarts(netudp::WatchdogComponent::Worker), 4);
+    ASSERT_EQ(socket.watchdogRestarts(netudp::WatchdogComponent::RxSocket), 0);
+    ASSERT_GE(socket.watchdogRestartsTotal(), 4);
+    ASSERT_EQ(socket.lastWatchdogRestartReason(), QString("Fail to bind"));
+
+    socket.stop();
+    socket.clearWatchdogCounter();
+    ASSERT_EQ(socket.watchdogRestartsTotal(), 0);
+    ASSERT_EQ(socket.watchdogRestarts(netudp::WatchdogComponent::Worker), 0);
+}
+
+TEST(Watchdog, removedMembershipInterface)
+{
+    const auto group = QStringLiteral("239.1.10.1");
+    const auto loopback = QStringLiteral("lo");
+
+    Socket rx;
+    rx.setWatchdogPeriod(200);
+    rx.setMulticastLoopback(true);
+    // The second iface keep the listening list non empty once 'lo' is removed, so every iface isn't joined instead
+    rx.setMulticastListeningInterfaces({loopback, QStringLiteral("netudp-missing")});
+
+    // Source filters aren't supported on a dual stack socket, so joining 'lo' fail at each restart
+    ASSERT_TRUE(rx.joinMulticastGroup(group, QStringLiteral("127.0.0.1")));
+
+    QSignalSpy spyRestarted(&rx, &Socket::watchdogRestarted);
+    const auto loopbackRestarts = [&]()
+    {
+        int count = 0;
+        for(const auto& arguments: spyRestarted)
+        {
+            if(arguments.at(0).value<netudp::WatchdogComponent>() == netudp::WatchdogComponent::MulticastMembership &&
+                arguments.at(1).toString() == loopback)
+                ++count;
+        }
+        return count;
+    };
+
+    rx.start("::", 11320);
+    while(loopbackRestarts() < 2)
+        ASSERT_TRUE(spyRestarted.wait(1000));
+
+    // Restart still pending is cancelled with the iface
+    ASSERT_TRUE(rx.leaveMulticastInterface(loopback));
+    spyRestarted.clear();
+    QTest::qWait(1000);
+    ASSERT_EQ(loopbackRestarts(), 0);
+
+    rx.stop();
+}
+
 TEST(WorkerMultithreadFuzz, restart)
 {
     Socket client;